@@ -0,0 +1,48 @@
+export module allocations;
+import std;
+
+/**
+ * Counts the allocations of the process, including the allocations in FTXUI.
+ *
+ * Linking this module replaces the global allocation functions, so it is only
+ * linked by the tests and the benchmarks measuring the allocations.
+ */
+static std::atomic<std::size_t> counter{0};
+
+// The replacements belong to the global module.
+extern "C++" {
+
+void *operator new(std::size_t size) {
+  counter.fetch_add(1, std::memory_order_relaxed);
+  if (void *result = std::malloc(size == 0 ? 1 : size))
+    return result;
+  throw std::bad_alloc{};
+}
+
+void *operator new[](std::size_t size) { return operator new(size); }
+
+void operator delete(void *pointer) noexcept { std::free(pointer); }
+void operator delete(void *pointer, std::size_t) noexcept {
+  std::free(pointer);
+}
+void operator delete[](void *pointer) noexcept { std::free(pointer); }
+void operator delete[](void *pointer, std::size_t) noexcept {
+  std::free(pointer);
+}
+}
+
+export namespace allocations {
+
+/** Returns the number of allocations made since the process started. */
+[[nodiscard]] std::size_t count() {
+  return counter.load(std::memory_order_relaxed);
+}
+
+/** Returns the number of allocations made by @p f. */
+template <class F> [[nodiscard]] std::size_t count(F f) {
+  std::size_t before = count();
+  f();
+  return count() - before;
+}
+
+} // namespace allocations
@@ -0,0 +1,410 @@
+export module analytics;
+import data;
+import std;
+import trace;
+
+export namespace analytics {
+
+/** A change of the status of a task. */
+struct ttransition {
+  std::chrono::sys_seconds time;
+  std::size_t task;
+  data::ttask::tstatus from;
+  data::ttask::tstatus to;
+
+  bool operator==(const ttransition &) const = default;
+};
+
+/** The history of the board in @p path, stored next to the board. */
+[[nodiscard]] std::string history_path(const std::string &path) {
+  return path + ".history";
+}
+
+/** The metrics of the board in @p path, stored next to the board. */
+[[nodiscard]] std::string metrics_path(const std::string &path) {
+  return path + ".metrics";
+}
+
+/**
+ * Returns @p transition as a line of the history.
+ *
+ * A line contains the time in seconds since the epoch, the id of the task,
+ * and the old and new status, separated by spaces.
+ */
+[[nodiscard]] std::string format(const ttransition &transition) {
+  return std::format(
+      "{} {} {} {}\n", transition.time.time_since_epoch().count(),
+      transition.task,
+      data::status_names[static_cast<std::size_t>(transition.from)],
+      data::status_names[static_cast<std::size_t>(transition.to)]);
+}
+
+/** Returns the transition in @p line, without its line break. */
+[[nodiscard]] std::optional<ttransition>
+parse_transition(std::string_view line) {
+  auto fields = line | std::views::split(' ') |
+                std::views::transform([](auto field) {
+                  return std::string_view{field};
+                });
+  std::array<std::string_view, 4> values;
+  std::size_t count = 0;
+  for (std::string_view field : fields) {
+    if (count == values.size())
+      return {};
+    values[count++] = field;
+  }
+  if (count != values.size())
+    return {};
+
+  auto parse_number = [](std::string_view input, auto &value) {
+    std::from_chars_result result =
+        std::from_chars(input.data(), input.data() + input.size(), value);
+    return result.ec == std::errc{} &&
+           result.ptr == input.data() + input.size();
+  };
+  auto parse_status = [](std::string_view input)
+      -> std::optional<data::ttask::tstatus> {
+    auto iter = std::ranges::find(data::status_names, input);
+    if (iter == data::status_names.end())
+      return {};
+    return static_cast<data::ttask::tstatus>(iter -
+                                             data::status_names.begin());
+  };
+
+  std::int64_t seconds;
+  std::size_t task;
+  std::optional<data::ttask::tstatus> from = parse_status(values[2]);
+  std::optional<data::ttask::tstatus> to = parse_status(values[3]);
+  if (!parse_number(values[0], seconds) || !parse_number(values[1], task) ||
+      !from || !to)
+    return {};
+
+  return ttransition{.time = std::chrono::sys_seconds{
+                         std::chrono::seconds{seconds}},
+                     .task = task,
+                     .from = *from,
+                     .to = *to};
+}
+
+/**
+ * Parses the history in @p input.
+ *
+ * Returns the transitions in the order of the input or the number of the
+ * first invalid line. An incomplete last line, from an interrupted append,
+ * is ignored.
+ */
+[[nodiscard]] std::expected<std::vector<ttransition>, int>
+parse_history(std::string_view input) {
+  trace::tspan span{"analytics::parse_history"};
+
+  std::vector<ttransition> result;
+  int line_no = 0;
+  for (std::size_t end = input.find('\n'); end != std::string_view::npos;
+       end = input.find('\n')) {
+    ++line_no;
+    std::string_view line = input.substr(0, end);
+    input.remove_prefix(end + 1);
+    if (line.empty())
+      continue;
+
+    std::optional<ttransition> transition = parse_transition(line);
+    if (!transition)
+      return std::unexpected{line_no};
+    result.push_back(*transition);
+  }
+  return result;
+}
+
+/**
+ * Appends @p transition to the history in @p path.
+ *
+ * The history is only appended to, so a line is never rewritten and a crash
+ * can at most leave an incomplete last line.
+ */
+[[nodiscard]] bool append(const std::string &path,
+                          const ttransition &transition) {
+  std::ofstream file{path, std::ios::binary | std::ios::app};
+  file << format(transition);
+  return static_cast<bool>(file.flush());
+}
+
+/** The records the metrics are grouped by. */
+enum class tdimension { board, project, group, label };
+
+/** The names of the dimensions as used in the metrics file. */
+inline constexpr std::array<std::string_view, 4> dimension_names{
+    "board", "project", "group", "label"};
+
+/** The metrics of the tasks completed in a period. */
+struct tbucket {
+  /** The number of tasks done, the throughput. */
+  std::size_t done{0};
+  /** The total time from starting progress to done. */
+  std::chrono::seconds cycle_time{0};
+  /** The number of done tasks with a known start. */
+  std::size_t cycles{0};
+  /** The total time from entering the history to done. */
+  std::chrono::seconds lead_time{0};
+
+  tbucket &operator+=(const tbucket &rhs) {
+    done += rhs.done;
+    cycle_time += rhs.cycle_time;
+    cycles += rhs.cycles;
+    lead_time += rhs.lead_time;
+    return *this;
+  }
+
+  [[nodiscard]] std::optional<std::chrono::seconds> average_cycle_time() const {
+    if (cycles == 0)
+      return {};
+    return cycle_time / static_cast<std::int64_t>(cycles);
+  }
+
+  [[nodiscard]] std::optional<std::chrono::seconds> average_lead_time() const {
+    if (done == 0)
+      return {};
+    return lead_time / static_cast<std::int64_t>(done);
+  }
+
+  bool operator==(const tbucket &) const = default;
+};
+
+/**
+ * The flow metrics of the board.
+ *
+ * The metrics are updated for every transition added and stored per day, per
+ * project, group, and label of the task. So a query only sums the days in its
+ * window and never visits the history.
+ *
+ * A task is started when it first moves to progress, it enters the board at
+ * its first transition. Every move to done counts, so a task reopened and done
+ * again counts twice.
+ *
+ * The metrics are stored next to the history, see serialize, together with
+ * the size of the history they contain. So the history is only read to add
+ * the transitions appended since the metrics were stored.
+ */
+class tmetrics {
+public:
+  /** Returns the task of a transition, or nullptr when it is unknown. */
+  using tfind = std::function<const data::ttask *(std::size_t)>;
+
+  /**
+   * Adds @p transition.
+   *
+   * The transitions should be added in the order of the history. When
+   * @p task is set the transition is also added to the project, group, and
+   * labels of the task; a task in a group counts for the project of the
+   * group. The task is a record of board @p board of the state, the metrics
+   * store the ids of the board itself, see data::board_id.
+   */
+  void add(const ttransition &transition, const data::ttask *task,
+           std::size_t board = 0) {
+    ttimes &times = tasks_[transition.task];
+    if (!times.entered)
+      times.entered = transition.time;
+    if (!times.started && transition.to == data::ttask::tstatus::progress)
+      times.started = transition.time;
+
+    if (transition.to != data::ttask::tstatus::done)
+      return;
+
+    tbucket bucket{.done = 1, .lead_time = transition.time - *times.entered};
+    if (times.started) {
+      bucket.cycle_time = transition.time - *times.started;
+      bucket.cycles = 1;
+    }
+
+    auto day = std::chrono::floor<std::chrono::days>(transition.time);
+    buckets_[{tdimension::board, 0}][day] += bucket;
+    if (!task)
+      return;
+
+    auto local = [&](std::size_t id) {
+      return board == 0 ? id : id & data::max_board_id;
+    };
+    // A task in a group belongs to the project of the group.
+    std::size_t project = task->project;
+    if (!project && task->group)
+      if (const data::tgroup *group = data::find_group(task->group))
+        project = group->project;
+    if (project)
+      buckets_[{tdimension::project, local(project)}][day] += bucket;
+    if (task->group)
+      buckets_[{tdimension::group, local(task->group)}][day] += bucket;
+    for (std::size_t label : task->labels)
+      buckets_[{tdimension::label, local(label)}][day] += bucket;
+  }
+
+  /**
+   * Adds the transitions in @p history, the part of the history after
+   * history_size.
+   *
+   * Only complete lines are added, an incomplete last line is added by the
+   * next call. Returns false when a line is invalid.
+   *
+   * The tasks are looked up with @p find when their transitions are added.
+   * So the transitions count for the project, group, and labels the task has
+   * at that time, not when the transition was recorded. A transition already
+   * in the stored metrics keeps its records.
+   */
+  [[nodiscard]] bool add_history(std::string_view history, const tfind &find,
+                                 std::size_t board = 0) {
+    trace::tspan span{"analytics::tmetrics::add_history"};
+
+    history = history.substr(0, history.rfind('\n') + 1);
+    std::expected<std::vector<ttransition>, int> transitions =
+        parse_history(history);
+    if (!transitions)
+      return false;
+
+    for (const ttransition &transition : *transitions)
+      add(transition, find(transition.task), board);
+    history_size_ += history.size();
+    return true;
+  }
+
+  /** Returns the number of bytes of the history added by add_history. */
+  [[nodiscard]] std::size_t history_size() const { return history_size_; }
+
+  /**
+   * Returns the metrics of the record @p id of @p dimension for the tasks
+   * done from @p first to @p last, inclusive.
+   *
+   * The board has id 0.
+   */
+  [[nodiscard]] tbucket query(tdimension dimension, std::size_t id,
+                              std::chrono::sys_days first,
+                              std::chrono::sys_days last) const {
+    tbucket result;
+    auto iter = buckets_.find({dimension, id});
+    if (iter == buckets_.end())
+      return result;
+
+    const auto &days = iter->second;
+    for (auto day = days.lower_bound(first);
+         day != days.end() && day->first <= last; ++day)
+      result += day->second;
+    return result;
+  }
+
+  /**
+   * Returns the metrics as stored in the metrics file.
+   *
+   * The first line contains the history size, followed by a line per task
+   * with the id and the entered and started times, and a line per day and
+   * record with its bucket. The times are seconds since the epoch, the days
+   * days since the epoch, a missing time is a dash.
+   */
+  [[nodiscard]] std::string serialize() const {
+    trace::tspan span{"analytics::tmetrics::serialize"};
+
+    std::string result;
+    std::back_insert_iterator out{result};
+    std::format_to(out, "history {}\n", history_size_);
+
+    auto time = [](std::optional<std::chrono::sys_seconds> value) {
+      return value ? std::format("{}", value->time_since_epoch().count())
+                   : std::string{"-"};
+    };
+    for (const auto &[id, times] : tasks_)
+      std::format_to(out, "task {} {} {}\n", id, time(times.entered),
+                     time(times.started));
+
+    for (const auto &[key, days] : buckets_)
+      for (const auto &[day, bucket] : days)
+        std::format_to(out, "bucket {} {} {} {} {} {} {}\n",
+                       dimension_names[static_cast<std::size_t>(key.first)],
+                       key.second, day.time_since_epoch().count(), bucket.done,
+                       bucket.cycle_time.count(), bucket.cycles,
+                       bucket.lead_time.count());
+    return result;
+  }
+
+  /** Parses the output of serialize, returns nothing when it is invalid. */
+  [[nodiscard]] static std::optional<tmetrics> parse(std::string_view input) {
+    trace::tspan span{"analytics::tmetrics::parse"};
+
+    auto parse_number = [](std::string_view field, auto &value) {
+      std::from_chars_result result =
+          std::from_chars(field.data(), field.data() + field.size(), value);
+      return result.ec == std::errc{} &&
+             result.ptr == field.data() + field.size();
+    };
+    auto parse_time = [&](std::string_view field,
+                          std::optional<std::chrono::sys_seconds> &value) {
+      if (field == "-")
+        return true;
+      std::int64_t seconds;
+      if (!parse_number(field, seconds))
+        return false;
+      value = std::chrono::sys_seconds{std::chrono::seconds{seconds}};
+      return true;
+    };
+
+    tmetrics result;
+    bool header = false;
+    for (auto range : input | std::views::split('\n')) {
+      std::string_view line{range};
+      if (line.empty())
+        continue;
+
+      std::vector<std::string_view> fields;
+      for (auto field : line | std::views::split(' '))
+        fields.emplace_back(field);
+
+      if (fields[0] == "history" && fields.size() == 2 && !header) {
+        if (!parse_number(fields[1], result.history_size_))
+          return {};
+        header = true;
+      } else if (fields[0] == "task" && fields.size() == 4 && header) {
+        std::size_t id;
+        ttimes times;
+        if (!parse_number(fields[1], id) ||
+            !parse_time(fields[2], times.entered) ||
+            !parse_time(fields[3], times.started))
+          return {};
+        result.tasks_[id] = times;
+      } else if (fields[0] == "bucket" && fields.size() == 8 && header) {
+        auto dimension = std::ranges::find(dimension_names, fields[1]);
+        std::size_t id;
+        std::chrono::days::rep day;
+        std::int64_t cycle_time;
+        std::int64_t lead_time;
+        tbucket bucket;
+        if (dimension == dimension_names.end() ||
+            !parse_number(fields[2], id) || !parse_number(fields[3], day) ||
+            !parse_number(fields[4], bucket.done) ||
+            !parse_number(fields[5], cycle_time) ||
+            !parse_number(fields[6], bucket.cycles) ||
+            !parse_number(fields[7], lead_time))
+          return {};
+        bucket.cycle_time = std::chrono::seconds{cycle_time};
+        bucket.lead_time = std::chrono::seconds{lead_time};
+        result.buckets_[{static_cast<tdimension>(
+                             dimension - dimension_names.begin()),
+                         id}][std::chrono::sys_days{std::chrono::days{day}}] =
+            bucket;
+      } else
+        return {};
+    }
+    if (!header)
+      return {};
+    return result;
+  }
+
+private:
+  struct ttimes {
+    std::optional<std::chrono::sys_seconds> entered{};
+    std::optional<std::chrono::sys_seconds> started{};
+  };
+
+  /** The size of the history added by add_history. */
+  std::size_t history_size_{0};
+  std::unordered_map<std::size_t, ttimes> tasks_{};
+  std::map<std::pair<tdimension, std::size_t>,
+           std::map<std::chrono::sys_days, tbucket>>
+      buckets_{};
+};
+
+} // namespace analytics
@@ -0,0 +1,3 @@
+export module bench;
+export import :generator;
+export import :harness;
@@ -0,0 +1,131 @@
+export module bench:generator;
+import std;
+
+export namespace bench {
+
+/** The shape of a generated board. */
+struct toptions {
+  std::size_t tasks{1000};
+  /** The maximum number of dependencies of a task. */
+  std::size_t fan_out{2};
+  /** The approximate size of a description in bytes, 0 means none. */
+  std::size_t description_size{200};
+  std::size_t labels{10};
+  std::size_t projects{5};
+  std::size_t groups_per_project{4};
+  std::uint_fast32_t seed{42};
+};
+
+/**
+ * Generates the input of a board.
+ *
+ * The output is deterministic for the same options. The tasks are
+ * distributed over the statuses like a board that has been used for a
+ * while; most tasks are done. Dependencies only refer to earlier tasks, so
+ * the generated board is always valid.
+ */
+[[nodiscard]] std::string generate(const toptions &options) {
+  constexpr std::array<std::string_view, 8> colors{
+      "black", "red", "green", "yellow", "blue", "magenta", "cyan", "white"};
+  constexpr std::array<std::string_view, 8> words{
+      "implement", "the",    "parser", "board", "column",
+      "review",    "ticket", "label"};
+
+  std::mt19937 generator{options.seed};
+  auto random = [&](std::size_t max) {
+    return std::uniform_int_distribution<std::size_t>{0, max}(generator);
+  };
+
+  std::string result;
+  std::back_insert_iterator out{result};
+
+  for (std::size_t id = 1; id <= options.labels; ++id)
+    std::format_to(out, "[label]\nid={}\nname=label {}\ncolor={}\n\n", id, id,
+                   colors[id % colors.size()]);
+
+  std::size_t groups = options.projects * options.groups_per_project;
+  for (std::size_t id = 1; id <= options.projects; ++id)
+    std::format_to(out, "[project]\nid={}\nname=project {}\ncolor={}\n\n", id,
+                   id, colors[id % colors.size()]);
+
+  for (std::size_t id = 1; id <= groups; ++id)
+    std::format_to(out, "[group]\nid={}\nproject={}\nname=group {}\n\n", id,
+                   (id - 1) / options.groups_per_project + 1, id);
+
+  for (std::size_t id = 1; id <= options.tasks; ++id) {
+    std::format_to(out, "[task]\nid={}\n", id);
+
+    // A third of the tasks belongs to a group, a third to a project.
+    switch (id % 3) {
+    case 0:
+      if (groups)
+        std::format_to(out, "group={}\n", random(groups - 1) + 1);
+      break;
+    case 1:
+      if (options.projects)
+        std::format_to(out, "project={}\n", random(options.projects - 1) + 1);
+      break;
+    }
+
+    std::format_to(out, "title=");
+    for (std::size_t i = 0, e = random(5) + 2; i < e; ++i)
+      std::format_to(out, "{}{}", i ? " " : "", words[random(words.size() - 1)]);
+    std::format_to(out, " {}\n", id);
+
+    if (options.description_size) {
+      std::format_to(out, "description=<<<\n");
+      std::size_t line = 0;
+      for (std::size_t size = 0; size < options.description_size;) {
+        std::string_view word = words[random(words.size() - 1)];
+        std::format_to(out, "{} ", word);
+        size += word.size() + 1;
+        line += word.size() + 1;
+        if (line > 60) {
+          std::format_to(out, "\n");
+          line = 0;
+        }
+      }
+      std::format_to(out, "\n>>>\n");
+    }
+
+    std::size_t status = random(99);
+    std::format_to(out, "status={}\n",
+                   status < 30   ? "backlog"
+                   : status < 40 ? "selected"
+                   : status < 45 ? "progress"
+                   : status < 50 ? "review"
+                   : status < 95 ? "done"
+                                 : "discarded");
+
+    if (options.labels) {
+      std::size_t count = random(3);
+      for (std::size_t i = 0; i < count; ++i)
+        std::format_to(out, "{}{}", i ? ", " : "labels=",
+                       random(options.labels - 1) + 1);
+      if (count)
+        std::format_to(out, "\n");
+    }
+
+    if (id > 1 && options.fan_out) {
+      std::size_t count = random(options.fan_out);
+      for (std::size_t i = 0; i < count; ++i)
+        std::format_to(out, "{}{}", i ? ", " : "dependencies=",
+                       random(id - 2) + 1);
+      if (count)
+        std::format_to(out, "\n");
+    }
+
+    if (groups && random(19) == 0)
+      std::format_to(out, "requirements={}\n", random(groups - 1) + 1);
+
+    if (random(9) == 0)
+      std::format_to(out, "after=2024.{}.{}\n", random(11) + 1,
+                     random(27) + 1);
+
+    std::format_to(out, "\n");
+  }
+
+  return result;
+}
+
+} // namespace bench
@@ -0,0 +1,154 @@
+export module bench:harness;
+import std;
+
+export namespace bench {
+
+/** Keeps the optimizer from removing the benchmarked code. */
+template <class T> void keep(const T &value) {
+  static const void *volatile sink;
+  sink = std::addressof(value);
+}
+
+/** Parses the value of @p argument when it starts with @p name. */
+template <class T>
+bool parse_argument(std::string_view argument, std::string_view name,
+                    T &value) {
+  if (!argument.starts_with(name))
+    return false;
+
+  argument.remove_prefix(name.size());
+  std::from_chars_result result = std::from_chars(
+      argument.data(), argument.data() + argument.size(), value);
+  if (result.ec != std::errc{} ||
+      result.ptr != argument.data() + argument.size())
+    throw std::invalid_argument(std::format("invalid value for {}", name));
+
+  return true;
+}
+
+struct tresult {
+  std::string name;
+  std::size_t iterations;
+  /** The average real time per iteration in nanoseconds. */
+  double real_time;
+  /** The average CPU time per iteration in nanoseconds. */
+  double cpu_time;
+  /** The average increase of every counter per iteration. */
+  std::vector<std::pair<std::string, double>> counters{};
+};
+
+/**
+ * Runs the benchmarks and collects their results.
+ *
+ * Every benchmark is repeated until it ran for at least the minimum time.
+ * The report uses the same JSON layout as Google Benchmark, so the results of
+ * two builds can be compared with its tools.
+ */
+class tharness {
+public:
+  explicit tharness(std::chrono::duration<double> min_time)
+      : min_time_(min_time) {}
+
+  template <class F> void run(std::string name, F f) {
+    std::vector<std::size_t> counters;
+    for (const auto &counter : counters_)
+      counters.push_back(counter.second());
+
+    std::size_t iterations = 0;
+    auto real_start = std::chrono::steady_clock::now();
+    std::clock_t cpu_start = std::clock();
+    std::chrono::steady_clock::duration elapsed;
+    do {
+      f();
+      ++iterations;
+      elapsed = std::chrono::steady_clock::now() - real_start;
+    } while (elapsed < min_time_);
+    std::clock_t cpu = std::clock() - cpu_start;
+
+    std::vector<std::pair<std::string, double>> increases;
+    for (std::size_t i = 0; i < counters_.size(); ++i) // zip view
+      increases.emplace_back(
+          counters_[i].first,
+          static_cast<double>(counters_[i].second() - counters[i]) /
+              static_cast<double>(iterations));
+
+    double real_time =
+        std::chrono::duration<double, std::nano>(elapsed).count() /
+        static_cast<double>(iterations);
+    double cpu_time = static_cast<double>(cpu) * 1e9 /
+                      static_cast<double>(clocks_per_second) /
+                      static_cast<double>(iterations);
+
+    std::println(std::cerr, "{:40} {:12.0f} ns {:10}", name, real_time,
+                 iterations);
+    results_.emplace_back(std::move(name), iterations, real_time, cpu_time,
+                          std::move(increases));
+  }
+
+  /**
+   * Adds a counter to all benchmarks run after this call.
+   *
+   * The report contains the average increase of the value returned by
+   * @p read per iteration.
+   */
+  void counter(std::string name, std::function<std::size_t()> read) {
+    counters_.emplace_back(std::move(name), std::move(read));
+  }
+
+  /** Adds a key to the context of the report. */
+  void context(std::string key, std::string value) {
+    context_.emplace_back(std::move(key), std::move(value));
+  }
+
+  void report(std::ostream &os) const {
+    std::println(os, "{{");
+    std::println(os, R"(  "context": {{)");
+    std::println(os, R"(    "date": "{:%FT%T}",)",
+                 std::chrono::floor<std::chrono::seconds>(
+                     std::chrono::system_clock::now()));
+    for (const auto &[key, value] : context_)
+      std::println(os, R"(    "{}": "{}",)", key, value);
+    std::println(os, R"(    "library_build_type": "{}")", build_type);
+    std::println(os, "  }},");
+    std::println(os, R"(  "benchmarks": [)");
+    for (std::size_t i = 0; i < results_.size(); ++i) {
+      const tresult &result = results_[i];
+      std::println(os, R"(    {{
+      "name": "{}",
+      "run_name": "{}",
+      "run_type": "iteration",
+      "iterations": {},
+      "real_time": {},
+      "cpu_time": {},)",
+                   result.name, result.name, result.iterations,
+                   result.real_time, result.cpu_time);
+      // Google Benchmark stores the user counters in the benchmark object.
+      for (const auto &[name, value] : result.counters)
+        std::println(os, R"(      "{}": {},)", name, value);
+      std::println(os, R"(      "time_unit": "ns"
+    }}{})",
+                   i + 1 == results_.size() ? "" : ",");
+    }
+    std::println(os, "  ]");
+    std::println(os, "}}");
+  }
+
+private:
+  // CLOCKS_PER_SEC is a macro, so it is not available in the std module.
+  // POSIX requires its value to be one million.
+  static constexpr std::clock_t clocks_per_second = 1'000'000;
+
+#ifdef NDEBUG
+  static constexpr std::string_view build_type = "release";
+#else
+  static constexpr std::string_view build_type = "debug";
+#endif
+
+  std::chrono::duration<double> min_time_;
+  std::vector<std::pair<std::string, std::string>> context_{};
+  std::vector<std::pair<std::string, std::function<std::size_t()>>>
+      counters_{};
+  std::vector<tresult> results_{};
+};
+
+} // namespace bench
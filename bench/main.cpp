@@ -0,0 +1,128 @@
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+
+import bench;
+import cli;
+import data;
+import ftxui;
+import gui;
+import std;
+
+namespace {
+
+struct tconfiguration {
+  bench::toptions options{};
+  std::chrono::milliseconds min_time{500};
+};
+
+tconfiguration parse_arguments(std::span<const char *> arguments) {
+  using bench::parse_argument;
+
+  tconfiguration result;
+  auto min_time = result.min_time.count();
+  for (std::string_view argument : arguments)
+    if (!parse_argument(argument, "--tasks=", result.options.tasks) &&
+        !parse_argument(argument, "--fan-out=", result.options.fan_out) &&
+        !parse_argument(argument, "--description-size=",
+                        result.options.description_size) &&
+        !parse_argument(argument, "--labels=", result.options.labels) &&
+        !parse_argument(argument, "--seed=", result.options.seed) &&
+        !parse_argument(argument, "--min-time-ms=", min_time))
+      throw std::invalid_argument(
+          std::format("unknown argument »{}«", argument));
+
+  result.min_time = std::chrono::milliseconds{min_time};
+  return result;
+}
+
+void set_state(std::string_view input) {
+  std::expected<std::unique_ptr<data::tstate>, data::tparse_error> result =
+      data::parse(input);
+  if (!result)
+    throw std::runtime_error(std::format("generated board is invalid: {}:{}",
+                                         result.error().line_no,
+                                         result.error().message));
+  if (!data::set_state(std::move(result).value()))
+    throw std::runtime_error("failed to store the state");
+}
+
+void run(bench::tharness &harness, const std::string &input) {
+  harness.run("parse", [&] { bench::keep(data::parse(input)); });
+
+  set_state(input);
+  const data::tstate &state = data::get_state();
+
+  harness.run("get_label", [&] {
+    for (const auto &label : state.labels)
+      bench::keep(data::get_label(label.id));
+  });
+  harness.run("get_project", [&] {
+    for (const auto &project : state.projects)
+      bench::keep(data::get_project(project.id));
+  });
+  harness.run("get_group", [&] {
+    for (const auto &group : state.groups)
+      bench::keep(data::get_group(group.id));
+  });
+  harness.run("get_task", [&] {
+    for (const auto &task : state.tasks)
+      bench::keep(data::get_task(task.id));
+  });
+
+  harness.run("is_blocked", [&] {
+    std::size_t blocked = 0;
+    for (const auto &task : state.tasks)
+      blocked += data::is_blocked(task) ? 1 : 0;
+    bench::keep(blocked);
+  });
+  harness.run("is_active", [&] {
+    std::size_t active = 0;
+    for (const auto &task : state.tasks)
+      active += data::is_active(task) ? 1 : 0;
+    bench::keep(active);
+  });
+
+  // Export to /dev/null, so the benchmark measures the exporter, not the
+  // disk.
+  int null = ::open("/dev/null", O_WRONLY | O_CLOEXEC);
+  if (null < 0)
+    throw std::system_error(errno, std::generic_category(),
+                            "failed to open /dev/null");
+  harness.run("export_json", [&] {
+    cli::toutput output{null};
+    cli::export_json(state, output);
+  });
+  harness.run("export_csv", [&] {
+    cli::toutput output{null};
+    cli::export_csv(state, output);
+  });
+  ::close(null);
+
+  harness.run("board", [] { bench::keep(gui::board()); });
+}
+
+} // namespace
+
+int main(int argc, const char *argv[]) {
+  try {
+    tconfiguration configuration = parse_arguments(
+        std::span{argv + 1, static_cast<std::size_t>(argc - 1)});
+
+    std::string input = bench::generate(configuration.options);
+
+    bench::tharness harness{configuration.min_time};
+    harness.context("tasks", std::to_string(configuration.options.tasks));
+    harness.context("fan_out", std::to_string(configuration.options.fan_out));
+    harness.context("description_size",
+                    std::to_string(configuration.options.description_size));
+    harness.context("labels", std::to_string(configuration.options.labels));
+    harness.context("input_size", std::to_string(input.size()));
+
+    run(harness, input);
+    harness.report(std::cout);
+  } catch (const std::exception &e) {
+    std::println(std::cerr, "{}", e.what());
+    return 1;
+  }
+}
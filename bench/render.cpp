@@ -0,0 +1,116 @@
+import allocations;
+import bench;
+import data;
+import ftxui;
+import gui;
+import std;
+
+namespace {
+
+struct tconfiguration {
+  std::vector<std::size_t> sizes{1'000, 10'000, 100'000};
+  int width{200};
+  int height{60};
+  std::chrono::milliseconds min_time{500};
+};
+
+tconfiguration parse_arguments(std::span<const char *> arguments) {
+  using bench::parse_argument;
+
+  tconfiguration result;
+  auto min_time = result.min_time.count();
+  std::size_t tasks = 0;
+  for (std::string_view argument : arguments)
+    if (parse_argument(argument, "--tasks=", tasks))
+      result.sizes = {tasks};
+    else if (!parse_argument(argument, "--width=", result.width) &&
+             !parse_argument(argument, "--height=", result.height) &&
+             !parse_argument(argument, "--min-time-ms=", min_time))
+      throw std::invalid_argument(
+          std::format("unknown argument »{}«", argument));
+
+  result.min_time = std::chrono::milliseconds{min_time};
+  return result;
+}
+
+void set_state(std::size_t tasks) {
+  std::string input = bench::generate(bench::toptions{.tasks = tasks});
+  std::expected<std::unique_ptr<data::tstate>, data::tparse_error> result =
+      data::parse(input);
+  if (!result)
+    throw std::runtime_error(std::format("generated board is invalid: {}:{}",
+                                         result.error().line_no,
+                                         result.error().message));
+  if (!data::set_state(std::move(result).value()))
+    throw std::runtime_error("failed to store the state");
+}
+
+/** Renders @p component into the off-screen @p screen. */
+void render(ftxui::Screen &screen, const ftxui::Component &component) {
+  ftxui::Render(screen, component->Render());
+  bench::keep(screen);
+}
+
+/**
+ * Benchmarks a view.
+ *
+ * build measures creating the components, first_frame creating them and
+ * rendering the first frame, frame rendering an unchanged view, and navigate
+ * handling a cursor movement and rendering the next frame.
+ */
+void run(bench::tharness &harness, ftxui::Screen &screen,
+         std::string_view name, std::size_t tasks,
+         ftxui::Component (*create)()) {
+  auto benchmark = [&](std::string_view kind) {
+    return std::format("{}/{}/{}", name, kind, tasks);
+  };
+
+  harness.run(benchmark("build"), [&] { bench::keep(create()); });
+  harness.run(benchmark("first_frame"), [&] { render(screen, create()); });
+
+  ftxui::Component component = create();
+  render(screen, component);
+  harness.run(benchmark("frame"), [&] { render(screen, component); });
+
+  bool down = true;
+  harness.run(benchmark("navigate"), [&] {
+    component->OnEvent(down ? ftxui::Event::ArrowDown
+                            : ftxui::Event::ArrowUp);
+    down = !down;
+    render(screen, component);
+  });
+}
+
+} // namespace
+
+int main(int argc, const char *argv[]) {
+  try {
+    tconfiguration configuration = parse_arguments(
+        std::span{argv + 1, static_cast<std::size_t>(argc - 1)});
+
+    // The columns use the height of their layout box to determine the
+    // visible tickets, the first frame uses the terminal size instead. When
+    // the output is not a terminal FTXUI uses the fallback size.
+    ftxui::Terminal::SetFallbackSize(
+        ftxui::Dimensions{configuration.width, configuration.height});
+    ftxui::Screen screen{configuration.width, configuration.height};
+
+    bench::tharness harness{configuration.min_time};
+    harness.context("width", std::to_string(configuration.width));
+    harness.context("height", std::to_string(configuration.height));
+    harness.counter("allocations", [] {
+      return allocations::count();
+    });
+
+    for (std::size_t tasks : configuration.sizes) {
+      set_state(tasks);
+      run(harness, screen, "board", tasks, gui::board);
+      run(harness, screen, "configuration", tasks, gui::configuration);
+    }
+
+    harness.report(std::cout);
+  } catch (const std::exception &e) {
+    std::println(std::cerr, "{}", e.what());
+    return 1;
+  }
+}
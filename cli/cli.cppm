@@ -0,0 +1,109 @@
+export module cli;
+export import :client;
+export import :exporter;
+export import :load;
+import :commands;
+import :serve;
+
+import std;
+
+static constexpr std::string_view usage = R"(Usage: kaban [command]
+
+Without a command the board is shown.
+
+The board is read from $HOME/kaban. KABAN_BOARDS can contain a
+colon-separated list of boards to open together instead.
+
+Commands:
+  check [--all]       Validates the board, with --all every error is
+                      reported instead of the first one
+  list [--column=C]   Lists the tasks, optionally only those in column C
+                      (inactive, blocked, backlog, selected, progress,
+                      review, done, discarded)
+  show <id>           Shows a task, board:id shows a task of another
+                      board when several boards are loaded
+  export --format=F   Writes the tasks to stdout as F (json, csv)
+  memory              Shows the memory used by the loaded board
+  metrics [--days=N]  Shows the throughput, cycle time, and lead time of
+                      the last N days, 28 by default
+  move <id> <status>  Changes the status of a task
+                      (backlog, selected, progress, review, done,
+                      discarded)
+  archive             Moves the done and discarded tasks to the archive
+  serve               Serves the board to the other commands, so the board
+                      is parsed once and the changes are made in one place
+)";
+
+export namespace cli {
+
+/**
+ * Runs a command without starting the user interface.
+ *
+ * These commands don't create any FTXUI components, so they are cheap
+ * enough for scripts and hooks.
+ */
+int run(std::span<const char *> arguments) {
+  std::string_view command = arguments[0];
+  arguments = arguments.subspan(1);
+  std::vector<std::string> paths = default_paths();
+
+  if (command == "check" && arguments.empty())
+    return check(paths);
+  if (command == "check" && arguments.size() == 1 &&
+      std::string_view{arguments[0]} == "--all")
+    return check_all(paths);
+
+  if (command == "list") {
+    constexpr std::string_view option = "--column=";
+    if (arguments.empty())
+      return list(paths, {});
+    if (arguments.size() == 1 &&
+        std::string_view{arguments[0]}.starts_with(option))
+      return list(paths, std::string_view{arguments[0]}.substr(option.size()));
+  }
+
+  if (command == "show" && arguments.size() == 1)
+    return show(paths, arguments[0]);
+
+  if (command == "memory" && arguments.empty())
+    return memory(paths);
+
+  if (command == "metrics") {
+    constexpr std::string_view option = "--days=";
+    if (arguments.empty())
+      return metrics(paths, "28");
+    if (arguments.size() == 1 &&
+        std::string_view{arguments[0]}.starts_with(option))
+      return metrics(paths,
+                     std::string_view{arguments[0]}.substr(option.size()));
+  }
+
+  if (command == "export" && arguments.size() == 1) {
+    constexpr std::string_view option = "--format=";
+    if (std::string_view{arguments[0]}.starts_with(option))
+      return export_boards(
+          paths, std::string_view{arguments[0]}.substr(option.size()));
+  }
+
+  // Changes are saved to the board file, this is ambiguous for merged boards.
+  if ((command == "move" || command == "archive" || command == "serve") &&
+      paths.size() != 1) {
+    std::print(std::cerr, "{} requires a single board in KABAN_BOARDS\n",
+               command);
+    return 2;
+  }
+
+  if (command == "move" && arguments.size() == 2)
+    return move_task(paths[0], arguments[0], arguments[1]);
+
+  if (command == "archive" && arguments.empty())
+    return archive(paths[0]);
+
+  if (command == "serve" && arguments.empty())
+    return serve(paths[0]);
+
+  std::print(std::cerr, "{}", usage);
+  return 2;
+}
+
+} // namespace cli
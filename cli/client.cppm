@@ -0,0 +1,102 @@
+module;
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+export module cli:client;
+import :protocol;
+import data;
+import std;
+
+export namespace cli {
+
+/** A connection to kaban serve. */
+class tclient {
+public:
+  /**
+   * Connects to the server listening on @p socket.
+   *
+   * Returns nothing when no server is running, then the caller should load
+   * the board itself.
+   */
+  [[nodiscard]] static std::optional<tclient>
+  connect(const std::string &socket) {
+    std::optional<sockaddr_un> address = make_address(socket);
+    if (!address)
+      return {};
+
+    tclient result{::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0)};
+    if (result.fd_ < 0 ||
+        ::connect(result.fd_, reinterpret_cast<const sockaddr *>(&*address),
+                  sizeof(*address)) != 0)
+      return {};
+
+    return result;
+  }
+
+  tclient(tclient &&other) noexcept : fd_(std::exchange(other.fd_, -1)) {}
+  tclient &operator=(tclient &&other) noexcept {
+    std::swap(fd_, other.fd_);
+    return *this;
+  }
+  tclient(const tclient &) = delete;
+  tclient &operator=(const tclient &) = delete;
+  ~tclient() {
+    if (fd_ >= 0)
+      ::close(fd_);
+  }
+
+  /**
+   * Sends the request @p payload.
+   *
+   * Returns the text of the response, or the error message of the server.
+   */
+  [[nodiscard]] std::expected<std::string, std::string>
+  request(std::string_view payload) {
+    if (!write_all(fd_, make_frame(payload)))
+      return std::unexpected{"Failed sending the request"};
+
+    std::optional<std::string> frame = read_frame(fd_);
+    if (!frame || frame->empty())
+      return std::unexpected{"Failed receiving the response"};
+
+    auto code = static_cast<tresponse>(frame->front());
+    frame->erase(0, 1);
+    if (code != tresponse::ok)
+      return std::unexpected{std::move(*frame)};
+    return std::move(*frame);
+  }
+
+private:
+  explicit tclient(int fd) : fd_(fd) {}
+
+  int fd_;
+};
+
+/** Returns whether a server owns the board in @p path. */
+[[nodiscard]] bool is_served(const std::string &path) {
+  return tclient::connect(socket_path(path)).has_value();
+}
+
+/**
+ * Sends the status change of task @p id to the server of the board in
+ * @p path.
+ *
+ * Returns nothing when no server is running, else whether the server saved
+ * the change. Nothing is printed, the caller shows the result.
+ */
+[[nodiscard]] std::optional<bool>
+send_status(const std::string &path, std::size_t id,
+            data::ttask::tstatus status) {
+  std::optional<tclient> client = tclient::connect(socket_path(path));
+  if (!client)
+    return {};
+
+  std::string message;
+  put(message, static_cast<std::uint8_t>(trequest::set_status));
+  put(message, static_cast<std::uint64_t>(id));
+  put(message, static_cast<std::uint8_t>(status));
+  return client->request(message).has_value();
+}
+
+} // namespace cli
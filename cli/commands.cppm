@@ -0,0 +1,337 @@
+export module cli:commands;
+import :client;
+import :exporter;
+import :format;
+import :load;
+import :protocol;
+import analytics;
+import data;
+import std;
+
+/**
+ * Sends @p payload to the server of the board in @p paths.
+ *
+ * Returns nothing when no server is running, a server only serves a single
+ * board. Else prints the response and returns the exit code.
+ */
+static std::optional<int> request(std::span<const std::string> paths,
+                                  std::string_view payload) {
+  if (paths.size() != 1)
+    return {};
+
+  std::optional<cli::tclient> client =
+      cli::tclient::connect(cli::socket_path(paths[0]));
+  if (!client)
+    return {};
+
+  std::expected<std::string, std::string> response = client->request(payload);
+  if (!response) {
+    std::print(std::cerr, "{}", response.error());
+    return 1;
+  }
+
+  std::print("{}", *response);
+  return 0;
+}
+
+static std::string make_request(cli::trequest request) {
+  std::string result;
+  cli::put(result, static_cast<std::uint8_t>(request));
+  return result;
+}
+
+export namespace cli {
+
+/** Validates the boards, the parser reports the errors. */
+int check(std::span<const std::string> paths) { return load(paths) ? 0 : 1; }
+
+/** Validates the boards, reporting all errors instead of the first one. */
+int check_all(std::span<const std::string> paths) {
+  int result = 0;
+  for (const std::string &path : paths) {
+    std::ifstream file{path};
+    if (!file) {
+      std::print(std::cerr, "Failed opening\n{}\n", path);
+      result = 1;
+      continue;
+    }
+
+    std::string input{std::istreambuf_iterator<char>(file), {}};
+    std::vector<data::tparse_error> errors = data::validate(input);
+    if (errors.empty())
+      continue;
+
+    std::print(std::cerr, "Failed parsing\n");
+    for (const data::tparse_error &error : errors)
+      std::print(std::cerr, "{}:{}\n{}\n{}\n", path, error.line_no, error.line,
+                 error.message);
+    result = 1;
+  }
+  return result;
+}
+
+/**
+ * Lists the tasks per column.
+ *
+ * When @p column is set only the tasks in that column are listed, without a
+ * column header.
+ */
+int list(std::span<const std::string> paths,
+         std::optional<std::string_view> column) {
+  std::optional<data::tcolumn_index> index;
+  if (column) {
+    index = parse_column(*column);
+    if (!index) {
+      std::print(std::cerr, "Unknown column »{}«\n", *column);
+      return 2;
+    }
+  }
+
+  std::string message = make_request(trequest::list);
+  put(message, index ? static_cast<std::uint8_t>(*index) : all_columns);
+  if (std::optional<int> result = request(paths, message))
+    return *result;
+
+  if (!load(paths))
+    return 1;
+
+  // The archive only contains tasks of the done and discarded columns.
+  if ((!index || *index == data::tcolumn_index::done ||
+       *index == data::tcolumn_index::discarded) &&
+      !data::load_archive())
+    return 1;
+
+  std::print("{}", format_list(classify(data::get_state()), index));
+  return 0;
+}
+
+/** Shows all fields of a task. */
+int show(std::span<const std::string> paths, std::string_view id) {
+  std::optional<std::size_t> value = parse_task_id(id);
+  if (!value) {
+    std::print(std::cerr, "Invalid task id »{}«\n", id);
+    return 2;
+  }
+
+  std::string message = make_request(trequest::show);
+  put(message, static_cast<std::uint64_t>(*value));
+  if (std::optional<int> result = request(paths, message))
+    return *result;
+
+  if (!load(paths))
+    return 1;
+
+  const data::ttask *task = find_task(*value);
+  if (!task) {
+    std::print(std::cerr, "Task »{}« not found\n", id);
+    return 1;
+  }
+
+  std::print("{}", format_task(*task));
+  return 0;
+}
+
+/**
+ * Changes the status of a task.
+ *
+ * When a server is running it applies the change, else the board is loaded,
+ * changed, and saved.
+ */
+int move_task(const std::string &path, std::string_view id,
+              std::string_view status) {
+  std::optional<std::size_t> value = parse_id(id);
+  if (!value) {
+    std::print(std::cerr, "Invalid task id »{}«\n", id);
+    return 2;
+  }
+  std::optional<data::ttask::tstatus> target = parse_status(status);
+  if (!target) {
+    std::print(std::cerr, "Unknown status »{}«\n", status);
+    return 2;
+  }
+
+  std::string message = make_request(trequest::set_status);
+  put(message, static_cast<std::uint64_t>(*value));
+  put(message, static_cast<std::uint8_t>(*target));
+  if (std::optional<int> result = request(std::span{std::addressof(path), 1},
+                                          message))
+    return *result;
+
+  if (!load(path))
+    return 1;
+
+  if (!find_task(*value)) {
+    std::print(std::cerr, "Task »{}« not found\n", *value);
+    return 1;
+  }
+
+  data::ttask::tstatus old = find_task(*value)->status;
+  if (old == *target)
+    return 0;
+
+  data::set_status(*value, *target);
+  if (!save(path))
+    return 1;
+
+  return record_transition(path, *value, old, *target) ? 0 : 1;
+}
+
+/**
+ * Moves the done and discarded tasks to the archive.
+ *
+ * The archived tasks are no longer parsed when the board is loaded, only when
+ * they are needed.
+ */
+int archive(const std::string &path) {
+  // The server would overwrite the archived board with its own state.
+  if (tclient::connect(socket_path(path))) {
+    std::print(std::cerr, "Stop kaban serve before archiving\n");
+    return 1;
+  }
+
+  if (!load(path) || !data::load_archive())
+    return 1;
+
+  std::size_t count = data::archive(data::get_state());
+  if (count == 0)
+    return 0;
+
+  if (!save(path))
+    return 1;
+
+  std::print("Archived {} tasks\n", count);
+  return 0;
+}
+
+/**
+ * Shows the flow metrics of the tasks done in the last @p days days.
+ *
+ * The metrics are stored next to the histories of the boards, see
+ * load_metrics, a query only sums the buckets of its days.
+ */
+int metrics(std::span<const std::string> paths, std::string_view days) {
+  std::optional<std::size_t> count = parse_id(days);
+  if (!count || *count == 0) {
+    std::print(std::cerr, "Invalid number of days »{}«\n", days);
+    return 2;
+  }
+
+  if (!load(paths))
+    return 1;
+
+  const data::tstate &state = data::get_state();
+  std::vector<analytics::tmetrics> metrics;
+  for (std::size_t board = 0; board < paths.size(); ++board) {
+    std::optional<analytics::tmetrics> result =
+        load_metrics(paths[board], board);
+    if (!result)
+      return 1;
+    metrics.push_back(std::move(*result));
+  }
+
+  auto last = std::chrono::floor<std::chrono::days>(
+      std::chrono::system_clock::now());
+  auto first = last - std::chrono::days{*count - 1};
+  auto format_days = [](std::optional<std::chrono::seconds> duration) {
+    if (!duration)
+      return std::string{"-"};
+    return std::format("{:.1f}d",
+                       std::chrono::duration<double, std::ratio<86400>>{
+                           *duration}
+                           .count());
+  };
+  // The metrics of a board contain the ids of the board itself.
+  auto query = [&](analytics::tdimension dimension, std::size_t id) {
+    analytics::tbucket result;
+    if (dimension == analytics::tdimension::board)
+      for (const auto &board : metrics)
+        result += board.query(dimension, 0, first, last);
+    else if (paths.size() == 1)
+      result = metrics[0].query(dimension, id, first, last);
+    else
+      result = metrics[data::board_of(id)].query(
+          dimension, id & data::max_board_id, first, last);
+    return result;
+  };
+  auto print_row = [&](std::string_view name, analytics::tdimension dimension,
+                       std::size_t id) {
+    analytics::tbucket bucket = query(dimension, id);
+    if (dimension != analytics::tdimension::board && bucket.done == 0)
+      return;
+
+    std::print("{:30} {:>6} {:>10} {:>10}\n", name, bucket.done,
+               format_days(bucket.average_cycle_time()),
+               format_days(bucket.average_lead_time()));
+  };
+
+  std::print("{:30} {:>6} {:>10} {:>10}\n",
+             std::format("Last {} days", *count), "done", "cycle", "lead");
+  print_row("board", analytics::tdimension::board, 0);
+  for (const auto &project : state.projects)
+    print_row(std::format("project {}", project.name),
+              analytics::tdimension::project, project.id);
+  for (const auto &group : state.groups)
+    print_row(std::format("group {}", group.name),
+              analytics::tdimension::group, group.id);
+  for (const auto &label : state.labels)
+    print_row(std::format("label {}", label.name),
+              analytics::tdimension::label, label.id);
+  return 0;
+}
+
+/**
+ * Shows the memory of the loaded boards, by category.
+ *
+ * The archive is loaded too, so its row shows the memory of the archived
+ * tasks instead of only their ids.
+ */
+int memory(std::span<const std::string> paths) {
+  if (!load(paths) || !data::load_archive())
+    return 1;
+
+  data::tmemory_usage usage = data::memory_usage(data::get_state());
+  data::tmemory total;
+  auto print_row = [&](std::string_view name, const data::tmemory &memory) {
+    std::print("{:10} {:>10} {:>12} {:>12}\n", name, memory.count,
+               memory.size, memory.capacity);
+    total += memory;
+  };
+
+  std::print("{:10} {:>10} {:>12} {:>12}\n", "category", "count", "bytes",
+             "capacity");
+  print_row("records", usage.records);
+  print_row("strings", usage.strings);
+  print_row("ids", usage.ids);
+  print_row("archive", usage.archive);
+  std::print("{:10} {:>10} {:>12} {:>12}\n", "total", "", total.size,
+             total.capacity);
+  return 0;
+}
+
+/** Writes the boards to stdout as JSON or CSV. */
+int export_boards(std::span<const std::string> paths,
+                  std::string_view format) {
+  void (*exporter)(const data::tstate &, toutput &) = nullptr;
+  if (format == "json")
+    exporter = export_json;
+  else if (format == "csv")
+    exporter = export_csv;
+  else {
+    std::print(std::cerr, "Unknown format »{}«\n", format);
+    return 2;
+  }
+
+  // An export contains every task, including the archived ones.
+  if (!load(paths) || !data::load_archive())
+    return 1;
+
+  toutput output;
+  exporter(data::get_state(), output);
+  if (!output.flush()) {
+    std::print(std::cerr, "Failed writing the export\n");
+    return 1;
+  }
+  return 0;
+}
+
+} // namespace cli
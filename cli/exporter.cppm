@@ -0,0 +1,373 @@
+module;
+#include <cerrno>
+#include <unistd.h>
+
+export module cli:exporter;
+import data;
+import std;
+import trace;
+
+export namespace cli {
+
+/**
+ * A buffered writer to a file descriptor.
+ *
+ * The buffer has a fixed size, so the memory used by an export does not
+ * depend on the size of the board. The values are formatted directly into the
+ * buffer, without temporary strings.
+ */
+class toutput {
+public:
+  static constexpr std::size_t capacity = 64 * 1024;
+
+  explicit toutput(int fd = STDOUT_FILENO) : fd_(fd) {}
+  toutput(const toutput &) = delete;
+  toutput &operator=(const toutput &) = delete;
+  ~toutput() { flush(); }
+
+  void put(char c) {
+    if (size_ == capacity)
+      flush();
+    buffer_[size_++] = c;
+  }
+
+  void put(std::string_view data) {
+    if (data.size() > capacity - size_) {
+      flush();
+      if (data.size() > capacity) {
+        write(data);
+        return;
+      }
+    }
+    std::ranges::copy(data, buffer_.data() + size_);
+    size_ += data.size();
+  }
+
+  template <std::integral T> void put(T value) {
+    // Enough for any 64-bit integer.
+    if (capacity - size_ < 24)
+      flush();
+    std::to_chars_result result =
+        std::to_chars(buffer_.data() + size_, buffer_.data() + capacity, value);
+    size_ = static_cast<std::size_t>(result.ptr - buffer_.data());
+  }
+
+  /** Writes the buffer, returns false when a write failed. */
+  bool flush() {
+    write({buffer_.data(), size_});
+    size_ = 0;
+    return !failed_;
+  }
+
+  [[nodiscard]] bool failed() const { return failed_; }
+
+private:
+  void write(std::string_view data) {
+    while (!failed_ && !data.empty()) {
+      ssize_t written = ::write(fd_, data.data(), data.size());
+      if (written < 0) {
+        if (errno == EINTR)
+          continue;
+        failed_ = true;
+        return;
+      }
+      data.remove_prefix(static_cast<std::size_t>(written));
+    }
+  }
+
+  int fd_;
+  std::size_t size_{0};
+  bool failed_{false};
+  std::array<char, capacity> buffer_;
+};
+
+} // namespace cli
+
+/**
+ * Writes @p value as a JSON string.
+ *
+ * Most strings need no escaping, so the runs of characters that can be
+ * copied as-is are written in one call.
+ */
+static void put_json(cli::toutput &output, std::string_view value) {
+  static constexpr std::string_view hex = "0123456789abcdef";
+
+  output.put('"');
+  const char *run = value.data();
+  for (const char &c : value) {
+    auto byte = static_cast<unsigned char>(c);
+    if (byte >= 0x20 && c != '"' && c != '\\')
+      continue;
+
+    output.put(std::string_view{run, &c});
+    run = &c + 1;
+    switch (c) {
+    case '"':
+      output.put(R"(\")");
+      break;
+    case '\\':
+      output.put(R"(\\)");
+      break;
+    case '\n':
+      output.put(R"(\n)");
+      break;
+    case '\t':
+      output.put(R"(\t)");
+      break;
+    default:
+      output.put(R"(\u00)");
+      output.put(hex[byte >> 4]);
+      output.put(hex[byte & 0xF]);
+    }
+  }
+  output.put(std::string_view{run, value.data() + value.size()});
+  output.put('"');
+}
+
+/** Returns whether data::format_id shows @p id as a plain number. */
+static bool is_plain_id(std::size_t id, std::size_t boards) {
+  return boards == 1 || data::board_of(id) == 0;
+}
+
+/** Writes @p id as data::format_id shows it, without a temporary string. */
+static void put_id(cli::toutput &output, std::size_t id, std::size_t boards) {
+  if (is_plain_id(id, boards)) {
+    output.put(id);
+    return;
+  }
+  output.put(data::board_of(id));
+  output.put(':');
+  output.put(id & data::max_board_id);
+}
+
+/**
+ * Writes @p id as a JSON value, 0 means no record.
+ *
+ * An id of another board than the first is written as the string board:id,
+ * the raw namespaced id would mean nothing to the reader of the export.
+ */
+static void put_json_id(cli::toutput &output, std::size_t id,
+                        std::size_t boards) {
+  if (id == 0)
+    output.put("null");
+  else if (is_plain_id(id, boards))
+    output.put(id);
+  else {
+    output.put('"');
+    put_id(output, id, boards);
+    output.put('"');
+  }
+}
+
+static void put_json_ids(cli::toutput &output, std::span<const std::size_t> ids,
+                         std::size_t boards) {
+  output.put('[');
+  for (std::size_t i = 0; i < ids.size(); ++i) {
+    if (i)
+      output.put(',');
+    put_json_id(output, ids[i], boards);
+  }
+  output.put(']');
+}
+
+static void put_json_key(cli::toutput &output, std::string_view key) {
+  output.put(',');
+  put_json(output, key);
+  output.put(':');
+}
+
+/** Writes the fields every record has, without the closing brace. */
+template <class T>
+static void put_json_record(cli::toutput &output, const T &record,
+                            std::size_t boards) {
+  output.put(R"({"id":)");
+  put_json_id(output, record.id, boards);
+  if constexpr (requires { record.name; }) {
+    put_json_key(output, "name");
+    put_json(output, record.name);
+  }
+  if constexpr (requires { record.color; }) {
+    put_json_key(output, "color");
+    put_json(output,
+             data::color_names[static_cast<std::size_t>(record.color)]);
+  }
+  if constexpr (requires { record.active; }) {
+    put_json_key(output, "active");
+    output.put(record.active ? "true" : "false");
+  }
+  put_json_key(output, "description");
+  put_json(output, record.description);
+}
+
+template <class T>
+static void put_json_array(cli::toutput &output, std::string_view key,
+                           const std::pmr::vector<T> &records,
+                           std::size_t boards, auto fields) {
+  put_json(output, key);
+  output.put(":[");
+  for (std::size_t i = 0; i < records.size(); ++i) {
+    output.put(i ? ",\n" : "\n");
+    put_json_record(output, records[i], boards);
+    fields(records[i]);
+    output.put('}');
+  }
+  output.put("]");
+}
+
+/** Writes the date as YYYY-MM-DD. */
+static void put_date(cli::toutput &output,
+                     const std::chrono::year_month_day &date) {
+  auto put_padded = [&](unsigned value) {
+    if (value < 10)
+      output.put('0');
+    output.put(value);
+  };
+  output.put(static_cast<int>(date.year()));
+  output.put('-');
+  put_padded(static_cast<unsigned>(date.month()));
+  output.put('-');
+  put_padded(static_cast<unsigned>(date.day()));
+}
+
+/** Writes @p value as a CSV field, quoted only when needed. */
+static void put_csv(cli::toutput &output, std::string_view value) {
+  if (value.find_first_of(",\"\r\n") == std::string_view::npos) {
+    output.put(value);
+    return;
+  }
+
+  output.put('"');
+  for (std::size_t quote = value.find('"'); quote != std::string_view::npos;
+       quote = value.find('"')) {
+    output.put(value.substr(0, quote + 1));
+    output.put('"');
+    value.remove_prefix(quote + 1);
+  }
+  output.put(value);
+  output.put('"');
+}
+
+/** Writes @p ids as a space-separated CSV field. */
+static void put_csv_ids(cli::toutput &output, std::span<const std::size_t> ids,
+                        std::size_t boards) {
+  for (std::size_t i = 0; i < ids.size(); ++i) {
+    if (i)
+      output.put(' ');
+    put_id(output, ids[i], boards);
+  }
+}
+
+static void put_json_task(cli::toutput &output, const data::ttask &task,
+                          std::size_t boards) {
+  output.put(R"({"id":)");
+  put_json_id(output, task.id, boards);
+  put_json_key(output, "project");
+  put_json_id(output, task.project, boards);
+  put_json_key(output, "group");
+  put_json_id(output, task.group, boards);
+  put_json_key(output, "title");
+  put_json(output, task.title);
+  put_json_key(output, "status");
+  put_json(output, data::status_names[static_cast<std::size_t>(task.status)]);
+  put_json_key(output, "after");
+  if (task.after) {
+    output.put('"');
+    put_date(output, *task.after);
+    output.put('"');
+  } else
+    output.put("null");
+  put_json_key(output, "labels");
+  put_json_ids(output, task.labels, boards);
+  put_json_key(output, "dependencies");
+  put_json_ids(output, task.dependencies, boards);
+  put_json_key(output, "requirements");
+  put_json_ids(output, task.requirements, boards);
+  put_json_key(output, "description");
+  put_json(output, task.description);
+  output.put('}');
+}
+
+static void put_csv_task(cli::toutput &output, const data::ttask &task,
+                         std::size_t boards) {
+  put_id(output, task.id, boards);
+  output.put(',');
+  if (task.project)
+    put_id(output, task.project, boards);
+  output.put(',');
+  if (task.group)
+    put_id(output, task.group, boards);
+  output.put(',');
+  put_csv(output, task.title);
+  output.put(',');
+  output.put(data::status_names[static_cast<std::size_t>(task.status)]);
+  output.put(',');
+  if (task.after)
+    put_date(output, *task.after);
+  output.put(',');
+  put_csv_ids(output, task.labels, boards);
+  output.put(',');
+  put_csv_ids(output, task.dependencies, boards);
+  output.put(',');
+  put_csv_ids(output, task.requirements, boards);
+  output.put(',');
+  put_csv(output, task.description);
+  output.put("\r\n");
+}
+
+export namespace cli {
+
+/**
+ * Writes @p state as a JSON object.
+ *
+ * The object contains an array for every record type, the tasks are followed
+ * by the loaded archive. References to other records are ids, a missing
+ * project or group is null. When several boards are loaded the ids of the
+ * other boards than the first are strings board:id, see data::format_id.
+ */
+void export_json(const data::tstate &state, toutput &output) {
+  trace::tspan span{"cli::export_json"};
+
+  output.put('{');
+  put_json_array(output, "labels", state.labels, state.boards,
+                 [](const auto &) {});
+  output.put(',');
+  put_json_array(output, "projects", state.projects, state.boards,
+                 [](const auto &) {});
+  output.put(',');
+  put_json_array(output, "groups", state.groups, state.boards,
+                 [&](const data::tgroup &group) {
+                   put_json_key(output, "project");
+                   put_json_id(output, group.project, state.boards);
+                 });
+  output.put(',');
+  put_json(output, "tasks");
+  output.put(":[");
+  bool first = true;
+  for (const auto *tasks : {&state.tasks, &state.archive})
+    for (const auto &task : *tasks) {
+      output.put(first ? "\n" : ",\n");
+      first = false;
+      put_json_task(output, task, state.boards);
+    }
+  output.put("]}\n");
+}
+
+/**
+ * Writes the tasks of @p state as CSV.
+ *
+ * The first line contains the names of the columns, the tasks are followed
+ * by the loaded archive. Id lists are separated by spaces, a missing
+ * project, group, or date is an empty field. The ids are written as
+ * data::format_id shows them.
+ */
+void export_csv(const data::tstate &state, toutput &output) {
+  trace::tspan span{"cli::export_csv"};
+
+  output.put("id,project,group,title,status,after,labels,dependencies,"
+             "requirements,description\r\n");
+  for (const auto *tasks : {&state.tasks, &state.archive})
+    for (const auto &task : *tasks)
+      put_csv_task(output, task, state.boards);
+}
+
+} // namespace cli
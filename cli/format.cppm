@@ -0,0 +1,154 @@
+export module cli:format;
+import data;
+import std;
+
+export namespace cli {
+
+/**
+ * The tasks per column, in the order of the state.
+ *
+ * The loaded archived tasks follow the other tasks.
+ */
+using tcolumns =
+    std::array<std::vector<const data::ttask *>, data::column_count>;
+
+[[nodiscard]] tcolumns classify(const data::tstate &state) {
+  tcolumns result;
+  auto add = [&](const data::ttask &task) {
+    result[std::to_underlying(data::get_column_index(task))].push_back(
+        std::addressof(task));
+  };
+  std::ranges::for_each(state.tasks, add);
+  std::ranges::for_each(state.archive, add);
+  return result;
+}
+
+[[nodiscard]] std::optional<data::tcolumn_index>
+parse_column(std::string_view name) {
+  auto iter = std::ranges::find(data::column_keys, name);
+  if (iter == data::column_keys.end())
+    return {};
+
+  return static_cast<data::tcolumn_index>(iter - data::column_keys.begin());
+}
+
+[[nodiscard]] std::optional<data::ttask::tstatus>
+parse_status(std::string_view name) {
+  auto iter = std::ranges::find(data::status_names, name);
+  if (iter == data::status_names.end())
+    return {};
+
+  return static_cast<data::ttask::tstatus>(iter - data::status_names.begin());
+}
+
+[[nodiscard]] std::optional<std::size_t> parse_id(std::string_view id) {
+  std::size_t result;
+  std::from_chars_result status =
+      std::from_chars(id.data(), id.data() + id.size(), result);
+  if (status.ec != std::errc{} || status.ptr != id.data() + id.size())
+    return {};
+
+  return result;
+}
+
+/** Parses the id of a task, board:id refers to a task of another board. */
+[[nodiscard]] std::optional<std::size_t> parse_task_id(std::string_view id) {
+  std::size_t separator = id.find(':');
+  if (separator == std::string_view::npos)
+    return parse_id(id);
+
+  std::optional<std::size_t> board = parse_id(id.substr(0, separator));
+  std::optional<std::size_t> local = parse_id(id.substr(separator + 1));
+  if (!board || *board > data::max_board || !local ||
+      *local > data::max_board_id)
+    return {};
+  return data::board_id(*board, *local);
+}
+
+/**
+ * Returns the task with @p id, or nullptr when there is no such task.
+ *
+ * An archived task loads the archive.
+ */
+[[nodiscard]] const data::ttask *find_task(std::size_t id) {
+  return data::find_task(id);
+}
+
+/**
+ * Returns the output of the list command.
+ *
+ * When @p column is set only the tasks in that column are listed, without a
+ * column header.
+ */
+[[nodiscard]] std::string
+format_list(const tcolumns &columns,
+            std::optional<data::tcolumn_index> column) {
+  std::string result;
+  std::back_insert_iterator out{result};
+  auto format_task = [&](const data::ttask &task) {
+    std::format_to(out, "{:>3} {}\n", data::format_id(task.id), task.title);
+  };
+
+  if (column) {
+    for (const auto *task : columns[std::to_underlying(*column)])
+      format_task(*task);
+    return result;
+  }
+
+  for (std::size_t i = 0; i < data::column_count; ++i) {
+    if (columns[i].empty())
+      continue;
+
+    std::format_to(out, "{}\n", data::column_names[i]);
+    for (const auto *task : columns[i])
+      format_task(*task);
+  }
+  return result;
+}
+
+/** Returns the output of the show command, all fields of @p task. */
+[[nodiscard]] std::string format_task(const data::ttask &task) {
+  std::string result;
+  std::back_insert_iterator out{result};
+
+  std::format_to(out, "id           {}\n", data::format_id(task.id));
+  std::format_to(out, "title        {}\n", task.title);
+  std::format_to(out, "status       {}\n",
+                 data::status_names[static_cast<std::size_t>(task.status)]);
+  std::format_to(out, "column       {}\n",
+                 data::column_names[std::to_underlying(
+                     data::get_column_index(task))]);
+
+  if (task.project)
+    std::format_to(out, "project      {}\n",
+                   data::get_project(task.project).name);
+  if (task.group)
+    std::format_to(out, "group        {}\n", data::get_group(task.group).name);
+  if (!task.labels.empty()) {
+    std::format_to(out, "labels      ");
+    for (auto label : task.labels)
+      std::format_to(out, " [{}]", data::get_label(label).name);
+    std::format_to(out, "\n");
+  }
+  if (task.after)
+    std::format_to(out, "after        {:%Y.%m.%d}\n", *task.after);
+
+  if (!task.dependencies.empty()) {
+    std::format_to(out, "dependencies\n");
+    for (auto dependency : task.dependencies)
+      std::format_to(out, "{:>3} {}\n", data::format_id(dependency),
+                     data::get_task(dependency).title);
+  }
+  if (!task.requirements.empty()) {
+    std::format_to(out, "requirements\n");
+    for (auto requirement : task.requirements)
+      std::format_to(out, "{:>3} {}\n", data::format_id(requirement),
+                     data::get_group(requirement).name);
+  }
+  if (!task.description.empty())
+    std::format_to(out, "description\n{}\n", task.description);
+
+  return result;
+}
+
+} // namespace cli
@@ -0,0 +1,292 @@
+export module cli:load;
+import analytics;
+import data;
+import std;
+import trace;
+
+/**
+ * Reads and parses the board in @p path as board @p board of @p boards.
+ *
+ * Returns the state or the message describing the failure.
+ */
+static std::expected<std::unique_ptr<data::tstate>, std::string>
+parse_file(const std::string &path, std::size_t board, std::size_t boards) {
+  std::ifstream file{path};
+  if (!file)
+    return std::unexpected{std::format("Failed opening\n{}\n", path)};
+
+  std::string input{std::istreambuf_iterator<char>(file), {}};
+  std::expected<std::unique_ptr<data::tstate>, data::tparse_error> result =
+      data::parse(input);
+  if (!result) {
+    // The error refers to the input, so it is formatted here.
+    data::tparse_error error = std::move(result).error();
+    return std::unexpected{std::format(R"(Failed parsing
+{}:{}
+{}
+{}
+)",
+                                       path, error.line_no, error.line,
+                                       error.message)};
+  }
+  if (!data::namespace_ids(**result, board, boards))
+    return std::unexpected{std::format(
+        "Failed loading\n{}\nids larger than {} require a single board\n",
+        path, data::max_board_id)};
+
+  return std::move(result).value();
+}
+
+/** Replaces @p path with @p contents, see save. */
+static bool write_file(const std::string &path, std::string_view contents) {
+  std::string temporary = path + ".tmp";
+  {
+    std::ofstream file{temporary, std::ios::binary | std::ios::trunc};
+    file << contents;
+    if (!file.flush()) {
+      std::print(std::cerr, "Failed writing\n{}\n", temporary);
+      return false;
+    }
+  }
+
+  std::error_code error;
+  std::filesystem::rename(temporary, path, error);
+  if (error) {
+    std::print(std::cerr, "Failed replacing\n{}\n{}\n", path,
+               error.message());
+    return false;
+  }
+  return true;
+}
+
+export namespace cli {
+
+/** The archive of the board in @p path, stored next to the board. */
+[[nodiscard]] std::string archive_path(const std::string &path) {
+  return path + ".archive";
+}
+
+} // namespace cli
+
+/**
+ * Loads the archives of the boards in @p paths into @p state.
+ *
+ * On failure the error is written to stderr.
+ */
+static bool load_archives(std::span<const std::string> paths,
+                          data::tstate &state) {
+  for (std::size_t board = 0; board < paths.size(); ++board) {
+    std::string path = cli::archive_path(paths[board]);
+    std::ifstream file{path};
+    if (!file) {
+      // A board without archived tasks has no archive.
+      if (std::ranges::none_of(state.archived, [&](std::size_t id) {
+            return data::board_of(id) == board;
+          }))
+        continue;
+
+      std::print(std::cerr, "Failed opening\n{}\n", path);
+      return false;
+    }
+
+    std::string input{std::istreambuf_iterator<char>(file), {}};
+    if (std::optional<data::tparse_error> error =
+            data::parse_archive(state, input, board)) {
+      std::print(std::cerr, "Failed parsing\n{}:{}\n{}\n{}\n", path,
+                 error->line_no, error->line, error->message);
+      return false;
+    }
+  }
+  return true;
+}
+
+export namespace cli {
+
+/** The board file used when none is given. */
+[[nodiscard]] std::string default_path() {
+  const char *home = std::getenv("HOME");
+  return std::string{home ? home : ""} + "/kaban";
+}
+
+/**
+ * The board files used when none are given.
+ *
+ * KABAN_BOARDS contains a colon-separated list of board files, when not set
+ * the default_path is used.
+ */
+[[nodiscard]] std::vector<std::string> default_paths() {
+  const char *boards = std::getenv("KABAN_BOARDS");
+  if (!boards || !*boards)
+    return {default_path()};
+
+  std::vector<std::string> result;
+  for (auto path : std::views::split(std::string_view{boards}, ':'))
+    if (!path.empty())
+      result.emplace_back(std::string_view{path});
+  return result;
+}
+
+/**
+ * Parses the boards in @p paths and makes them the current state.
+ *
+ * The files are read and parsed concurrently, so loading takes about as long
+ * as loading the largest board. The ids of the boards are namespaced by their
+ * index in @p paths, see data::board_id, and a task can refer to a task or
+ * group of another board as board:id.
+ *
+ * On failure the errors are written to stderr, in the order of @p paths.
+ */
+[[nodiscard]] bool load(std::span<const std::string> paths) {
+  trace::tspan span{"cli::load"};
+
+  std::vector<std::expected<std::unique_ptr<data::tstate>, std::string>>
+      results(paths.size());
+  if (paths.size() == 1)
+    results[0] = parse_file(paths[0], 0, 1);
+  else {
+    std::atomic<std::size_t> next{0};
+    auto run = [&] {
+      for (std::size_t i = next++; i < paths.size(); i = next++)
+        results[i] = parse_file(paths[i], i, paths.size());
+    };
+    std::size_t count = std::min<std::size_t>(
+        paths.size(), std::max(1U, std::thread::hardware_concurrency()));
+    std::vector<std::jthread> threads;
+    for (std::size_t i = 1; i < count; ++i)
+      threads.emplace_back(run);
+    run();
+  }
+
+  std::vector<std::unique_ptr<data::tstate>> states;
+  for (auto &result : results) {
+    if (!result)
+      std::cerr << result.error();
+    else
+      states.push_back(std::move(result).value());
+  }
+  if (states.size() != paths.size())
+    return false;
+
+  std::unique_ptr<data::tstate> state = data::merge(std::move(states));
+  if (std::optional<std::string> error = data::resolve_references(*state)) {
+    std::print(std::cerr, "Failed linking the boards\n{}\n", *error);
+    return false;
+  }
+
+  if (!data::set_state(std::move(state))) {
+    std::cerr << "Failed to store the state\n";
+    return false;
+  }
+
+  // Most commands never use the archive, it is loaded when an archived task
+  // is referenced.
+  data::set_archive_loader(
+      [paths = std::vector<std::string>(paths.begin(), paths.end())](
+          data::tstate &state) { return load_archives(paths, state); });
+  return true;
+}
+
+/**
+ * Parses the board in @p path and makes it the current state.
+ *
+ * On failure the error is written to stderr.
+ */
+[[nodiscard]] bool load(const std::string &path) {
+  return load(std::span{std::addressof(path), 1});
+}
+
+/**
+ * Writes the current state to @p path.
+ *
+ * When the archive is loaded it is written too, before the board. Every file
+ * is written to a temporary file which replaces the original, so a failure
+ * never leaves a partially written file. On failure the error is written to
+ * stderr.
+ */
+[[nodiscard]] bool save(const std::string &path) {
+  const data::tstate &state = data::get_state();
+  if (state.archive_loaded &&
+      !write_file(archive_path(path), data::serialize_archive(state)))
+    return false;
+
+  return write_file(path, data::serialize(state));
+}
+
+/**
+ * Returns the metrics of the board in @p path, board @p board of the state.
+ *
+ * The stored metrics are brought up to date with the history and stored
+ * again. Usually they are up to date, then the history is not read. A
+ * missing or invalid metrics file is rebuilt from the history.
+ *
+ * On failure the error is written to stderr.
+ */
+[[nodiscard]] std::optional<analytics::tmetrics>
+load_metrics(const std::string &path, std::size_t board) {
+  trace::tspan span{"cli::load_metrics"};
+
+  std::string metrics = analytics::metrics_path(path);
+  analytics::tmetrics result;
+  if (std::ifstream file{metrics, std::ios::binary}) {
+    std::string input{std::istreambuf_iterator<char>(file), {}};
+    if (std::optional<analytics::tmetrics> stored =
+            analytics::tmetrics::parse(input))
+      result = std::move(*stored);
+  }
+
+  // A missing history is empty.
+  std::string history = analytics::history_path(path);
+  std::ifstream file{history, std::ios::binary | std::ios::ate};
+  if (!file)
+    return result;
+
+  auto size = static_cast<std::size_t>(file.tellg());
+  if (size == result.history_size())
+    return result;
+  // The history has been replaced.
+  if (size < result.history_size())
+    result = {};
+
+  file.seekg(static_cast<std::streamoff>(result.history_size()));
+  std::string input{std::istreambuf_iterator<char>(file), {}};
+  if (!result.add_history(
+          input,
+          [board](std::size_t id) {
+            return data::find_task(data::board_id(board, id));
+          },
+          board)) {
+    std::print(std::cerr, "Failed parsing\n{}\n", history);
+    return {};
+  }
+
+  // The metrics can be rebuilt from the history, so failing to store them is
+  // not an error.
+  write_file(metrics, result.serialize());
+  return result;
+}
+
+/**
+ * Appends the change of the status of task @p id to the history of the board
+ * in @p path, and adds it to the metrics of the board.
+ *
+ * On failure the error is written to stderr.
+ */
+[[nodiscard]] bool record_transition(const std::string &path, std::size_t id,
+                                     data::ttask::tstatus from,
+                                     data::ttask::tstatus to) {
+  analytics::ttransition transition{
+      .time = std::chrono::floor<std::chrono::seconds>(
+          std::chrono::system_clock::now()),
+      .task = id,
+      .from = from,
+      .to = to};
+  std::string history = analytics::history_path(path);
+  if (!analytics::append(history, transition)) {
+    std::print(std::cerr, "Failed writing\n{}\n", history);
+    return false;
+  }
+  // The metrics pick up the transition from the history.
+  return load_metrics(path, 0).has_value();
+}
+
+} // namespace cli
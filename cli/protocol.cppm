@@ -0,0 +1,139 @@
+module;
+#include <cerrno>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+export module cli:protocol;
+import std;
+
+export namespace cli {
+
+/**
+ * The protocol between kaban serve and its clients.
+ *
+ * Every message is a frame, the size of the payload as a little-endian 32-bit
+ * integer followed by the payload. A request payload starts with a
+ * trequest byte followed by its arguments:
+ * - list, the column as a byte, all_columns for all columns,
+ * - show, the task id as a 64-bit integer,
+ * - set_status, the task id as a 64-bit integer and the status as a byte.
+ *
+ * A response payload starts with a tresponse byte followed by the text to
+ * print, for an error the text is the error message.
+ */
+enum class trequest : std::uint8_t { list, show, set_status };
+enum class tresponse : std::uint8_t { ok, error };
+
+/** The column argument of list to request all columns. */
+inline constexpr std::uint8_t all_columns = 0xFF;
+
+/** Larger frames are rejected, this limits the memory used by a peer. */
+inline constexpr std::size_t max_frame_size = std::size_t{16} << 20;
+
+/** Appends @p value as a little-endian integer to @p buffer. */
+template <std::unsigned_integral T>
+void put(std::string &buffer, T value) {
+  for (std::size_t i = 0; i < sizeof(T); ++i)
+    buffer.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+}
+
+/**
+ * Removes a little-endian integer from the front of @p buffer.
+ *
+ * Returns nothing when @p buffer is too small.
+ */
+template <std::unsigned_integral T>
+[[nodiscard]] std::optional<T> take(std::string_view &buffer) {
+  if (buffer.size() < sizeof(T))
+    return {};
+
+  T result{0};
+  for (std::size_t i = 0; i < sizeof(T); ++i) {
+    auto byte = static_cast<T>(static_cast<unsigned char>(buffer[i]));
+    result |= static_cast<T>(byte << (8 * i));
+  }
+  buffer.remove_prefix(sizeof(T));
+  return result;
+}
+
+/** Returns @p payload as a frame. */
+[[nodiscard]] std::string make_frame(std::string_view payload) {
+  std::string result;
+  result.reserve(sizeof(std::uint32_t) + payload.size());
+  put(result, static_cast<std::uint32_t>(payload.size()));
+  result.append(payload);
+  return result;
+}
+
+/**
+ * Removes the first complete frame from @p buffer and returns its payload.
+ *
+ * Returns nothing when the frame is incomplete, the caller should read more
+ * data. Throws when the frame is too large.
+ */
+[[nodiscard]] std::optional<std::string> take_frame(std::string &buffer) {
+  std::string_view view{buffer};
+  std::optional<std::uint32_t> size = take<std::uint32_t>(view);
+  if (!size)
+    return {};
+  if (*size > max_frame_size)
+    throw std::length_error("frame too large");
+  if (view.size() < *size)
+    return {};
+
+  std::string result{view.substr(0, *size)};
+  buffer.erase(0, sizeof(std::uint32_t) + *size);
+  return result;
+}
+
+/** Returns the socket of the server for the board in @p path. */
+[[nodiscard]] std::string socket_path(const std::string &path) {
+  return path + ".sock";
+}
+
+/** Returns the address of @p path, or nothing when the path is too long. */
+[[nodiscard]] std::optional<sockaddr_un> make_address(const std::string &path) {
+  sockaddr_un result{};
+  if (path.size() >= sizeof(result.sun_path))
+    return {};
+
+  result.sun_family = AF_UNIX;
+  std::ranges::copy(path, std::begin(result.sun_path));
+  return result;
+}
+
+/** Writes all of @p data to @p fd, returns false on failure. */
+[[nodiscard]] bool write_all(int fd, std::string_view data) {
+  while (!data.empty()) {
+    ssize_t written = ::write(fd, data.data(), data.size());
+    if (written < 0) {
+      if (errno == EINTR)
+        continue;
+      return false;
+    }
+    data.remove_prefix(static_cast<std::size_t>(written));
+  }
+  return true;
+}
+
+/** Reads a frame from the blocking @p fd, returns nothing on failure. */
+[[nodiscard]] std::optional<std::string> read_frame(int fd) try {
+  std::string buffer;
+  std::array<char, 4096> chunk;
+  while (true) {
+    if (std::optional<std::string> result = take_frame(buffer))
+      return result;
+
+    ssize_t count = ::read(fd, chunk.data(), chunk.size());
+    if (count < 0 && errno == EINTR)
+      continue;
+    if (count <= 0)
+      return {};
+    buffer.append(chunk.data(), static_cast<std::size_t>(count));
+  }
+} catch (const std::length_error &) {
+  return {};
+}
+
+} // namespace cli
@@ -0,0 +1,348 @@
+module;
+#include <cerrno>
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+export module cli:serve;
+import :format;
+import :load;
+import :protocol;
+import data;
+import std;
+
+static volatile std::sig_atomic_t stop_requested = 0;
+
+static void request_stop(int) { stop_requested = 1; }
+
+/**
+ * The indexes of the server.
+ *
+ * They are built once when the board is loaded and updated for every
+ * mutation, so a request never visits all tasks.
+ */
+class tindex {
+public:
+  explicit tindex(const data::tstate &state)
+      : columns_(cli::classify(state)), dependents_(state) {}
+
+  [[nodiscard]] const cli::tcolumns &columns() const { return columns_; }
+
+  /** Updates the columns after the status of @p task changed. */
+  void changed(const data::ttask &task) {
+    reclassify(task);
+    for (std::size_t id : dependents_.affected_by(task))
+      reclassify(data::get_task(id));
+  }
+
+private:
+  /** Moves @p task to its column. */
+  void reclassify(const data::ttask &task) {
+    const data::ttask *pointer = std::addressof(task);
+    for (auto &column : columns_)
+      if (auto iter = std::ranges::find(column, pointer); iter != column.end())
+        column.erase(iter);
+
+    auto &column = columns_[std::to_underlying(data::get_column_index(task))];
+    column.insert(std::ranges::lower_bound(column, rank(pointer), std::less{},
+                                           &tindex::rank),
+                  pointer);
+  }
+
+  /** Returns the position of @p task in the order of the columns. */
+  static std::size_t rank(const data::ttask *task) { return data::rank(*task); }
+
+  cli::tcolumns columns_;
+  data::tdependents dependents_;
+};
+
+[[nodiscard]] static std::string respond(cli::tresponse code,
+                                        std::string_view text) {
+  std::string result;
+  result.reserve(1 + text.size());
+  result.push_back(static_cast<char>(code));
+  result.append(text);
+  return result;
+}
+
+[[nodiscard]] static std::string
+handle(tindex &index, const std::string &path, std::string_view payload) {
+  std::optional<std::uint8_t> request = cli::take<std::uint8_t>(payload);
+  if (!request)
+    return respond(cli::tresponse::error, "Empty request\n");
+
+  switch (static_cast<cli::trequest>(*request)) {
+  case cli::trequest::list: {
+    std::optional<std::uint8_t> column = cli::take<std::uint8_t>(payload);
+    if (!column ||
+        (*column != cli::all_columns && *column >= data::column_count))
+      break;
+
+    std::optional<data::tcolumn_index> index_of;
+    if (*column != cli::all_columns)
+      index_of = static_cast<data::tcolumn_index>(*column);
+    return respond(cli::tresponse::ok,
+                   cli::format_list(index.columns(), index_of));
+  }
+
+  case cli::trequest::show: {
+    std::optional<std::uint64_t> id = cli::take<std::uint64_t>(payload);
+    if (!id)
+      break;
+
+    const data::ttask *task = cli::find_task(*id);
+    if (!task)
+      return respond(cli::tresponse::error,
+                     std::format("Task »{}« not found\n", *id));
+    return respond(cli::tresponse::ok, cli::format_task(*task));
+  }
+
+  case cli::trequest::set_status: {
+    std::optional<std::uint64_t> id = cli::take<std::uint64_t>(payload);
+    std::optional<std::uint8_t> status = cli::take<std::uint8_t>(payload);
+    if (!id || !status || *status >= data::status_names.size())
+      break;
+
+    const data::ttask *task = cli::find_task(*id);
+    if (!task)
+      return respond(cli::tresponse::error,
+                     std::format("Task »{}« not found\n", *id));
+
+    auto target = static_cast<data::ttask::tstatus>(*status);
+    data::ttask::tstatus old = task->status;
+    if (old == target)
+      return respond(cli::tresponse::ok, "");
+
+    // Reopening an archived task moves it back to the tasks, which
+    // invalidates the pointers of the index. Restoring the old status keeps
+    // the task active.
+    bool archived = data::is_archived(*id);
+    data::set_status(*id, target);
+    bool saved = cli::save(path);
+    if (!saved)
+      data::set_status(*id, old);
+    if (archived && !data::is_archived(*id))
+      index = tindex{data::get_state()};
+    else if (saved)
+      index.changed(*task);
+    if (!saved)
+      return respond(cli::tresponse::error, "Failed saving the board\n");
+    if (!cli::record_transition(path, *id, old, target))
+      return respond(cli::tresponse::error,
+                     "Saved the board, but failed recording the history\n");
+    return respond(cli::tresponse::ok, "");
+  }
+  }
+
+  return respond(cli::tresponse::error, "Malformed request\n");
+}
+
+/**
+ * A connected client.
+ *
+ * The socket is non-blocking, a client that does not read its responses must
+ * not block the other clients.
+ */
+struct tconnection {
+  int fd;
+  /** The partially received frame. */
+  std::string input{};
+  /** The responses not yet written. */
+  std::string output{};
+};
+
+/**
+ * Reads the available data of @p connection and queues the responses to its
+ * complete requests.
+ *
+ * Returns false when the connection should be closed.
+ */
+[[nodiscard]] static bool serve_connection(tindex &index,
+                                           const std::string &path,
+                                           tconnection &connection) {
+  std::array<char, 4096> chunk;
+  ssize_t count = ::read(connection.fd, chunk.data(), chunk.size());
+  if (count < 0)
+    return errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK;
+  if (count == 0)
+    return false;
+
+  connection.input.append(chunk.data(), static_cast<std::size_t>(count));
+  try {
+    while (std::optional<std::string> request =
+               cli::take_frame(connection.input))
+      connection.output += cli::make_frame(handle(index, path, *request));
+  } catch (const std::length_error &) {
+    return false;
+  }
+  return true;
+}
+
+/**
+ * Writes the queued responses of @p connection until the socket is full.
+ *
+ * Returns false when the connection should be closed.
+ */
+[[nodiscard]] static bool flush(tconnection &connection) {
+  std::string_view output{connection.output};
+  while (!output.empty()) {
+    ssize_t written = ::write(connection.fd, output.data(), output.size());
+    if (written < 0) {
+      if (errno == EINTR)
+        continue;
+      if (errno != EAGAIN && errno != EWOULDBLOCK)
+        return false;
+      break;
+    }
+    output.remove_prefix(static_cast<std::size_t>(written));
+  }
+  connection.output.erase(0, connection.output.size() - output.size());
+  return true;
+}
+
+/**
+ * Returns a socket listening on @p socket, or -1 on failure.
+ *
+ * A socket without a server, left behind by a crash, is replaced.
+ */
+[[nodiscard]] static int listen_on(const std::string &socket) {
+  std::optional<sockaddr_un> address = cli::make_address(socket);
+  if (!address) {
+    std::print(std::cerr, "Socket path too long\n{}\n", socket);
+    return -1;
+  }
+  const auto *generic = reinterpret_cast<const sockaddr *>(&*address);
+
+  int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (fd < 0)
+    return -1;
+
+  if (::bind(fd, generic, sizeof(*address)) != 0) {
+    if (errno != EADDRINUSE) {
+      ::close(fd);
+      return -1;
+    }
+
+    int probe = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    bool running = ::connect(probe, generic, sizeof(*address)) == 0;
+    ::close(probe);
+    if (running) {
+      std::print(std::cerr, "A server is already running on\n{}\n", socket);
+      ::close(fd);
+      return -1;
+    }
+
+    ::unlink(socket.c_str());
+    if (::bind(fd, generic, sizeof(*address)) != 0) {
+      ::close(fd);
+      return -1;
+    }
+  }
+
+  if (::listen(fd, SOMAXCONN) != 0) {
+    ::close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+export namespace cli {
+
+/**
+ * Serves the board in @p path until SIGINT or SIGTERM.
+ *
+ * The server owns the only copy of the state and its indexes, clients only
+ * send requests. The requests are handled one at a time on a single thread,
+ * so the mutations are serialized and every mutation is saved before it is
+ * acknowledged. The responses are queued and written when the client can
+ * receive them, a slow client does not stall the other clients.
+ *
+ * Saving writes the whole board, see data::serialize, so the records in the
+ * file end up grouped by kind.
+ *
+ * The user interface is not a client yet, it loads the board itself and
+ * does not save the tasks it moves. Don't run it next to a server.
+ */
+int serve(const std::string &path) {
+  if (!load(path))
+    return 1;
+
+  std::string socket = socket_path(path);
+  int listener = listen_on(socket);
+  if (listener < 0) {
+    std::print(std::cerr, "Failed listening on\n{}\n", socket);
+    return 1;
+  }
+
+  struct sigaction action{};
+  action.sa_handler = request_stop;
+  // Without SA_RESTART poll returns when a signal arrives.
+  ::sigaction(SIGINT, &action, nullptr);
+  ::sigaction(SIGTERM, &action, nullptr);
+  ::signal(SIGPIPE, SIG_IGN);
+
+  // The server outlives many requests, so it loads the archive once.
+  if (!data::load_archive())
+    return 1;
+
+  tindex index{data::get_state()};
+  std::vector<tconnection> connections;
+  std::vector<pollfd> fds;
+  while (!stop_requested) {
+    fds.clear();
+    fds.push_back(pollfd{.fd = listener, .events = POLLIN, .revents = 0});
+    for (const auto &connection : connections) {
+      // A client with a large backlog of responses gets no new responses
+      // until it has read them, this limits the memory used by a client.
+      auto events = static_cast<short>(
+          connection.output.size() < max_frame_size ? POLLIN : 0);
+      if (!connection.output.empty())
+        events = static_cast<short>(events | POLLOUT);
+      fds.push_back(
+          pollfd{.fd = connection.fd, .events = events, .revents = 0});
+    }
+
+    if (::poll(fds.data(), fds.size(), -1) < 0) {
+      if (errno == EINTR)
+        continue;
+      break;
+    }
+
+    // Handle the connections before accepting, the indices of fds match
+    // connections.
+    for (std::size_t i = connections.size(); i > 0; --i) {
+      tconnection &connection = connections[i - 1];
+      if (!fds[i].revents)
+        continue;
+
+      // Most responses fit in the socket buffer, so they are written right
+      // away instead of waiting for the next poll.
+      bool open = true;
+      if (fds[i].revents & ~POLLOUT)
+        open = serve_connection(index, path, connection);
+      if (open)
+        open = flush(connection);
+      if (!open) {
+        ::close(connection.fd);
+        connections.erase(connections.begin() +
+                          static_cast<std::ptrdiff_t>(i - 1));
+      }
+    }
+
+    if (fds[0].revents & POLLIN)
+      if (int fd = ::accept4(listener, nullptr, nullptr,
+                             SOCK_CLOEXEC | SOCK_NONBLOCK);
+          fd >= 0)
+        connections.push_back(tconnection{.fd = fd});
+  }
+
+  for (const auto &connection : connections)
+    ::close(connection.fd);
+  ::close(listener);
+  ::unlink(socket.c_str());
+  return 0;
+}
+
+} // namespace cli
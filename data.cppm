@@ -1,5 +1,7 @@
 export module data;
+import persistent;
 import std;
+import trace;
 
 export namespace data {
 enum class tcolor {
@@ -23,15 +25,15 @@ enum class tcolor {
 
 struct tlabel {
   std::size_t id;
-  std::string name;
-  std::string description{};
+  std::pmr::string name;
+  std::pmr::string description{};
   tcolor color{tcolor::black};
 };
 
 struct tproject {
   std::size_t id;
-  std::string name;
-  std::string description{};
+  std::pmr::string name;
+  std::pmr::string description{};
   tcolor color{tcolor::black};
   bool active{true};
 };
@@ -39,8 +41,8 @@ struct tproject {
 struct tgroup {
   std::size_t id;
   std::size_t project{0};
-  std::string name;
-  std::string description{};
+  std::pmr::string name;
+  std::pmr::string description{};
   tcolor color{tcolor::black};
   bool active{true};
 };
@@ -59,22 +61,61 @@ struct ttask {
   std::size_t id;
   std::size_t project{0};
   std::size_t group{0};
-  std::string title;
-  std::string description{};
+  std::pmr::string title;
+  std::pmr::string description{};
   tstatus status{tstatus::backlog};
   std::optional<std::chrono::year_month_day> after{};
-  std::vector<std::size_t> labels{};
-  std::vector<std::size_t> dependencies{};
-  std::vector<std::size_t> requirements{};
+  std::pmr::vector<std::size_t> labels{};
+  std::pmr::vector<std::size_t> dependencies{};
+  std::pmr::vector<std::size_t> requirements{};
 };
 
 struct tstate {
-  std::vector<tlabel> labels{};
-  std::vector<tproject> projects{};
-  std::vector<tgroup> groups{};
-  std::vector<ttask> tasks{};
+  /**
+   * The arena owning the memory of the records.
+   *
+   * The parser allocates all records, including their strings and id lists,
+   * in the arena. When not set the records use the default memory resource.
+   *
+   * This member is declared first, so it is destroyed after the records.
+   */
+  std::unique_ptr<std::pmr::monotonic_buffer_resource> arena{};
+  /**
+   * The arenas of the states merged into this state.
+   *
+   * Merging moves the records, their strings and id lists stay in the arena
+   * of the state they were parsed in.
+   */
+  std::vector<std::unique_ptr<std::pmr::monotonic_buffer_resource>>
+      merged_arenas{};
+  std::pmr::vector<tlabel> labels{};
+  std::pmr::vector<tproject> projects{};
+  std::pmr::vector<tgroup> groups{};
+  std::pmr::vector<ttask> tasks{};
+  /**
+   * The ids of the archived tasks, sorted.
+   *
+   * The archived tasks are done or discarded, they live in a separate file.
+   * This set is enough to know that a dependency on an archived task is
+   * complete, without loading the archive.
+   */
+  std::pmr::vector<std::size_t> archived{};
+  /** The archived tasks, empty until the archive is loaded. */
+  std::pmr::vector<ttask> archive{};
+  bool archive_loaded{false};
+  /** The number of boards merged into this state, see merge. */
+  std::size_t boards{1};
 };
 
+/** The names of the colors as used in the input, indexed by tcolor. */
+inline constexpr std::array<std::string_view, 16> color_names{
+    "black", "RED", "GREEN", "YELLOW", "BLUE", "MAGENTA", "CYAN", "gray",
+    "GRAY",  "red", "green", "yellow", "blue", "magenta", "cyan", "white"};
+
+/** The names of the statuses as used in the input. */
+inline constexpr std::array<std::string_view, 6> status_names = {
+    "backlog", "selected", "progress", "review", "done", "discarded"};
+
 struct tparse_error {
   int line_no;
   std::string_view line;
@@ -108,13 +149,126 @@ private:
 };
 
 static tsingleton<data::tstate> state_singleton;
+/**
+ * The number of times the state has been replaced or its tasks have moved.
+ */
+static std::size_t state_generation_counter{0};
+
+export namespace data {
+
+/** The records changed between two versions of the state, by id. */
+struct tchanges {
+  std::vector<std::size_t> labels{};
+  std::vector<std::size_t> projects{};
+  std::vector<std::size_t> groups{};
+  std::vector<std::size_t> tasks{};
+};
+
+} // namespace data
+
+/**
+ * A version of the records in the undo history.
+ *
+ * The tasks are the tasks of the state, the archive is not part of the
+ * history.
+ */
+struct tversion {
+  persistent::tvector<data::tlabel> labels{};
+  persistent::tvector<data::tproject> projects{};
+  persistent::tvector<data::tgroup> groups{};
+  persistent::tvector<data::ttask> tasks{};
+};
+
+/**
+ * The undo history of the state.
+ *
+ * Every change made through data adds a version. The versions share the
+ * records they did not change, so a version costs O(log n) memory, and undo
+ * and redo only select another version. The first version is created by the
+ * first change, so reading a board does not copy its records.
+ *
+ * The versions refer to the records by their position in the state, so the
+ * history is cleared when the state is replaced or its tasks move. The
+ * numbers of the versions keep increasing.
+ */
+class thistory {
+public:
+  /** Adds the version made by @p change, the versions to redo are dropped. */
+  template <class F> void record(const data::tstate &state, F change) {
+    if (versions_.empty())
+      versions_.push_back(tversion{
+          .labels = persistent::tvector<data::tlabel>(state.labels),
+          .projects = persistent::tvector<data::tproject>(state.projects),
+          .groups = persistent::tvector<data::tgroup>(state.groups),
+          .tasks = persistent::tvector<data::ttask>(state.tasks)});
+
+    versions_.resize(current_ + 1);
+    tversion version = versions_.back();
+    change(version);
+    versions_.push_back(std::move(version));
+    ++current_;
+  }
+
+  /** Drops the versions, the next version gets a new number. */
+  void clear() {
+    first_ = version() + 1;
+    versions_.clear();
+    current_ = 0;
+  }
+
+  /** Returns the number of the current version. */
+  [[nodiscard]] std::size_t version() const { return first_ + current_; }
+
+  /** Returns version @p number, or nullptr when it is not available. */
+  [[nodiscard]] const tversion *at(std::size_t number) const {
+    if (number < first_ || number - first_ >= versions_.size())
+      return nullptr;
+    return std::addressof(versions_[number - first_]);
+  }
+
+  [[nodiscard]] bool can_undo() const { return current_ != 0; }
+  [[nodiscard]] bool can_redo() const {
+    return current_ + 1 < versions_.size();
+  }
+
+  /** Makes the previous, -1, or next, 1, version the current version. */
+  void step(int direction) {
+    current_ = direction < 0 ? current_ - 1 : current_ + 1;
+  }
+
+private:
+  /** The number of the first version. */
+  std::size_t first_{0};
+  std::vector<tversion> versions_{};
+  std::size_t current_{0};
+};
+
+static thistory history;
 
 export namespace data {
 [[nodiscard]] tstate &get_state() { return state_singleton.get(); }
 
 [[nodiscard]] std::expected<void, std::nullptr_t>
 set_state(std::unique_ptr<data::tstate> &&state) {
-  return state_singleton.set(std::move(state));
+  std::expected<void, std::nullptr_t> result =
+      state_singleton.set(std::move(state));
+  if (result) {
+    ++state_generation_counter;
+    history.clear();
+  }
+  return result;
+}
+
+/**
+ * Returns the generation of the state, it changes when the state is replaced
+ * or the addresses of its tasks change.
+ *
+ * A cache referring to the records of the state should be dropped when the
+ * generation changes. A new state can reuse the addresses of the old one, and
+ * reopening an archived task moves the tasks, see set_status.
+ */
+[[nodiscard]] std::size_t state_generation() {
+  return state_generation_counter;
 }
 } // namespace data
 
@@ -124,20 +278,276 @@ bool is_complete(const data::ttask &task) {
 }
 
 bool is_complete(const data::tgroup &group) {
-  return std::ranges::all_of(data::get_state().tasks,
-                             [id = group.id](const data::ttask &task) {
-                               return id != task.group || is_complete(task);
-                             });
+  // The archived tasks are complete, unless the archive is loaded and they
+  // have been reopened.
+  auto complete = [id = group.id](const data::ttask &task) {
+    return id != task.group || is_complete(task);
+  };
+  const data::tstate &state = data::get_state();
+  return std::ranges::all_of(state.tasks, complete) &&
+         std::ranges::all_of(state.archive, complete);
 }
 
 template <class T>
-const T &get_record(const std::vector<T> &range, std::size_t id) {
+const T &get_record(const std::pmr::vector<T> &range, std::size_t id) {
   auto it = std::ranges::find(range, id, &T::id);
   if (it == range.end())
     throw 42;
   return *it;
 }
 
+template <class T> T &get_record(std::pmr::vector<T> &range, std::size_t id) {
+  auto it = std::ranges::find(range, id, &T::id);
+  if (it == range.end())
+    throw 42;
+  return *it;
+}
+
+template <class T>
+T *find_record(std::pmr::vector<T> &range, std::size_t id) {
+  auto it = std::ranges::find(range, id, &T::id);
+  return it == range.end() ? nullptr : std::addressof(*it);
+}
+
+/** Loads the archive of the current state, set by the application. */
+static std::function<bool(data::tstate &)> archive_loader;
+
+export namespace data {
+
+/**
+ * Sets the function loading the archive.
+ *
+ * The function should add the archived tasks to tstate::archive, data does
+ * not know where the archive is stored.
+ */
+void set_archive_loader(std::function<bool(tstate &)> loader) {
+  archive_loader = std::move(loader);
+}
+
+[[nodiscard]] bool is_archived(std::size_t id) {
+  return std::ranges::binary_search(get_state().archived, id);
+}
+
+/**
+ * Loads the archive of the current state, when it has not been loaded.
+ *
+ * Returns whether the archive is loaded.
+ */
+bool load_archive() {
+  tstate &state = get_state();
+  if (state.archive_loaded)
+    return true;
+
+  if (!state.archived.empty() && !archive_loader)
+    return false;
+
+  trace::tspan span{"data::load_archive"};
+  state.archive_loaded = state.archived.empty() || archive_loader(state);
+  return state.archive_loaded;
+}
+
+} // namespace data
+
+export namespace data {
+
+/** The kinds of records. */
+enum class tentity { label, project, group, task };
+
+/** The fields that can be changed, see subscribe. */
+enum class tattribute {
+  any,    /**< Only used to subscribe to the changes of all fields. */
+  status, /**< ttask::status */
+  active  /**< tproject::active and tgroup::active */
+};
+
+/** A change of a field of a record. */
+struct tchange {
+  tentity entity;
+  std::size_t id;
+  tattribute attribute;
+};
+
+using tlistener = std::function<void(const tchange &)>;
+
+/**
+ * A subscription to changes, see subscribe.
+ *
+ * Destroying the subscription unsubscribes, so the listener of a component
+ * is not called after the component has been destroyed.
+ */
+class tsubscription {
+public:
+  tsubscription() = default;
+  explicit tsubscription(std::size_t key) : key_(key) {}
+  tsubscription(tsubscription &&other) noexcept
+      : key_(std::exchange(other.key_, 0)) {}
+  tsubscription &operator=(tsubscription &&other) noexcept {
+    if (this != std::addressof(other)) {
+      reset();
+      key_ = std::exchange(other.key_, 0);
+    }
+    return *this;
+  }
+  ~tsubscription() { reset(); }
+
+  /** Unsubscribes. */
+  void reset();
+
+private:
+  std::size_t key_{0};
+};
+
+} // namespace data
+
+/**
+ * The listeners of the changes.
+ *
+ * The listeners of a single record are stored by its id, so a change only
+ * visits the listeners of its record and of all records of its kind.
+ */
+class tnotifier {
+public:
+  std::size_t subscribe(data::tentity entity, std::optional<std::size_t> id,
+                        data::tattribute attribute, data::tlistener listener) {
+    std::size_t key = ++last_key_;
+    listeners(entity, id).push_back(tentry{
+        .key = key,
+        .attribute = attribute,
+        .listener =
+            std::make_shared<const data::tlistener>(std::move(listener))});
+    locations_.emplace(key, tlocation{entity, id});
+    return key;
+  }
+
+  void unsubscribe(std::size_t key) {
+    auto node = locations_.extract(key);
+    if (node.empty())
+      return;
+
+    auto [entity, id] = node.mapped();
+    std::erase_if(listeners(entity, id),
+                  [key](const tentry &entry) { return entry.key == key; });
+    auto &by_id = by_id_[static_cast<std::size_t>(entity)];
+    if (id && by_id.at(*id).empty())
+      by_id.erase(*id);
+  }
+
+  void notify(const data::tchange &change) {
+    auto entity = static_cast<std::size_t>(change.entity);
+    std::vector<tentry> entries;
+    auto collect = [&](const std::vector<tentry> &listeners) {
+      for (const auto &entry : listeners)
+        if (entry.attribute == data::tattribute::any ||
+            entry.attribute == change.attribute)
+          entries.push_back(entry);
+    };
+    if (auto iter = by_id_[entity].find(change.id);
+        iter != by_id_[entity].end())
+      collect(iter->second);
+    collect(all_[entity]);
+
+    // A listener can destroy the subscriptions of other listeners.
+    for (const auto &entry : entries)
+      if (locations_.contains(entry.key))
+        (*entry.listener)(change);
+  }
+
+private:
+  struct tentry {
+    std::size_t key;
+    data::tattribute attribute;
+    /** Shared, so a listener survives unsubscribing while it is called. */
+    std::shared_ptr<const data::tlistener> listener;
+  };
+
+  struct tlocation {
+    data::tentity entity;
+    std::optional<std::size_t> id;
+  };
+
+  std::vector<tentry> &listeners(data::tentity entity,
+                                 std::optional<std::size_t> id) {
+    auto index = static_cast<std::size_t>(entity);
+    return id ? by_id_[index][*id] : all_[index];
+  }
+
+  std::size_t last_key_{0};
+  /** The listeners of all records, by entity. */
+  std::array<std::vector<tentry>, 4> all_{};
+  /** The listeners of a single record, by entity and id. */
+  std::array<std::unordered_map<std::size_t, std::vector<tentry>>, 4> by_id_{};
+  std::unordered_map<std::size_t, tlocation> locations_{};
+};
+
+static tnotifier notifier;
+
+void data::tsubscription::reset() {
+  if (key_)
+    notifier.unsubscribe(std::exchange(key_, 0));
+}
+
+export namespace data {
+
+/**
+ * Calls @p listener after a field of a record changes.
+ *
+ * @param id The record, all records of @p entity when not set.
+ * @param attribute The field, all fields when tattribute::any.
+ *
+ * The listener is called on the thread making the change. Returns the
+ * subscription, the listener is called while it exists.
+ */
+[[nodiscard]] tsubscription subscribe(tentity entity,
+                                      std::optional<std::size_t> id,
+                                      tattribute attribute,
+                                      tlistener listener) {
+  return tsubscription{
+      notifier.subscribe(entity, id, attribute, std::move(listener))};
+}
+
+} // namespace data
+
+/**
+ * Returns the task with @p id, or nullptr when there is no such task.
+ *
+ * A reference to an archived task loads the archive.
+ */
+static data::ttask *find_task_record(std::size_t id) {
+  data::tstate &state = data::get_state();
+  if (data::ttask *task = find_record(state.tasks, id))
+    return task;
+
+  if (data::is_archived(id) && data::load_archive())
+    return find_record(state.archive, id);
+
+  return nullptr;
+}
+
+static data::ttask &get_task_record(std::size_t id) {
+  data::ttask *task = find_task_record(id);
+  if (!task)
+    throw 42;
+  return *task;
+}
+
+/**
+ * Moves the archived @p task back to the tasks.
+ *
+ * The archive only contains complete tasks, so a reopened task is active
+ * again. This moves the other tasks as well, so it starts a new generation of
+ * the state and clears the undo history.
+ */
+static void reopen(data::ttask &task) {
+  ++state_generation_counter;
+  history.clear();
+  data::tstate &state = data::get_state();
+  std::size_t id = task.id;
+  state.tasks.push_back(std::move(task));
+  std::erase_if(state.archive,
+                [id](const data::ttask &record) { return record.id == id; });
+  state.archived.erase(std::ranges::lower_bound(state.archived, id));
+}
+
 export namespace data {
 const data::tlabel &get_label(std::size_t id) {
   return get_record(data::get_state().labels, id);
@@ -151,13 +561,41 @@ const data::tgroup &get_group(std::size_t id) {
   return get_record(data::get_state().groups, id);
 }
 
-const data::ttask &get_task(std::size_t id) {
-  return get_record(data::get_state().tasks, id);
+const data::ttask &get_task(std::size_t id) { return get_task_record(id); }
+
+/** Returns the task with @p id, or nullptr when there is no such task. */
+const data::ttask *find_task(std::size_t id) { return find_task_record(id); }
+
+/** Returns the group with @p id, or nullptr when there is no such group. */
+const data::tgroup *find_group(std::size_t id) {
+  return find_record(data::get_state().groups, id);
+}
+
+/**
+ * Returns the position of @p task in the state, the tasks followed by the
+ * archive.
+ *
+ * The task should be a record of the current state. The rank changes when
+ * the state_generation changes.
+ */
+[[nodiscard]] std::size_t rank(const data::ttask &task) {
+  const data::tstate &state = get_state();
+  const data::ttask *tasks = state.tasks.data();
+  const data::ttask *pointer = std::addressof(task);
+  if (std::less_equal{}(tasks, pointer) &&
+      std::less{}(pointer, tasks + state.tasks.size()))
+    return static_cast<std::size_t>(pointer - tasks);
+
+  return state.tasks.size() +
+         static_cast<std::size_t>(pointer - state.archive.data());
 }
 
 bool is_blocked(const data::ttask &task) {
+  // The archive only contains complete tasks, so a dependency on an archived
+  // task only needs the archive when it has been loaded anyway.
   if (std::ranges::any_of(task.dependencies, [](std::size_t id) {
-        return !is_complete(get_task(id));
+        return (get_state().archive_loaded || !is_archived(id)) &&
+               !is_complete(get_task(id));
       }))
     return true;
 
@@ -169,23 +607,545 @@ bool is_blocked(const data::ttask &task) {
   if (!task.after)
     return false;
 
-  return std::chrono::system_clock::now() <=
-         static_cast<std::chrono::sys_days>(*task.after);
+  return std::chrono::system_clock::now() <=
+         static_cast<std::chrono::sys_days>(*task.after);
+}
+
+bool is_active(const data::ttask &task) {
+  if (task.project != 0)
+    return get_project(task.project).active;
+
+  if (task.group == 0)
+    return true;
+
+  data::tgroup group = get_group(task.group);
+  return group.active && get_project(group.project).active;
+}
+
+/**
+ * The column of the board a task is shown in.
+ *
+ * The value is the index of the column, see std::to_underlying.
+ */
+enum class tcolumn_index : std::size_t {
+  inactive,
+  blocked,
+  backlog,
+  selected,
+  progress,
+  review,
+  done,
+  discarded
+};
+
+inline constexpr std::size_t column_count = 8;
+
+inline constexpr std::array<std::string_view, column_count> column_names = {
+    "Inactive",    "Blocked",   "Backlog", "Selected",
+    "In progress", "In review", "Done",    "Discarded"};
+
+/** The names of the columns used on the command line. */
+inline constexpr std::array<std::string_view, column_count> column_keys = {
+    "inactive", "blocked", "backlog", "selected",
+    "progress", "review",  "done",    "discarded"};
+
+tcolumn_index get_column_index(const data::ttask &task) {
+  trace::tspan span{"get_column_index"};
+
+  switch (task.status) {
+  case data::ttask::tstatus::backlog:
+    if (!is_active(task))
+      return tcolumn_index::inactive;
+
+    if (is_blocked(task))
+      return tcolumn_index::blocked;
+
+    return tcolumn_index::backlog;
+
+  case data::ttask::tstatus::selected:
+    return tcolumn_index::selected;
+
+  case data::ttask::tstatus::progress:
+    return tcolumn_index::progress;
+
+  case data::ttask::tstatus::review:
+    return tcolumn_index::review;
+
+  case data::ttask::tstatus::done:
+    return tcolumn_index::done;
+
+  case data::ttask::tstatus::discarded:
+    return tcolumn_index::discarded;
+  }
+}
+
+/**
+ * Changes the status of task @p id and notifies the subscribers.
+ *
+ * The change is added to the undo history, unless the task is archived.
+ * Reopening an archived task moves it back to the tasks, this invalidates
+ * the pointers to the tasks and changes the state_generation. The
+ * subscribers are notified after the move.
+ */
+void set_status(std::size_t id, ttask::tstatus status) {
+  ttask &task = get_task_record(id);
+  if (task.status == status)
+    return;
+
+  task.status = status;
+  if (!is_complete(task) && is_archived(id))
+    reopen(task);
+  else if (std::size_t index = rank(task); index < get_state().tasks.size())
+    history.record(get_state(), [&](tversion &version) {
+      version.tasks = version.tasks.set(index, task);
+    });
+  notifier.notify(tchange{tentity::task, id, tattribute::status});
+}
+
+/**
+ * Changes whether project @p id is active and notifies the subscribers.
+ *
+ * The change is added to the undo history.
+ */
+void set_project_active(std::size_t id, bool active) {
+  auto &projects = get_state().projects;
+  tproject &project = get_record(projects, id);
+  if (project.active == active)
+    return;
+
+  project.active = active;
+  history.record(get_state(), [&](tversion &version) {
+    version.projects = version.projects.set(
+        static_cast<std::size_t>(std::addressof(project) - projects.data()),
+        project);
+  });
+  notifier.notify(tchange{tentity::project, id, tattribute::active});
+}
+
+/**
+ * Changes whether group @p id is active and notifies the subscribers.
+ *
+ * The change is added to the undo history.
+ */
+void set_group_active(std::size_t id, bool active) {
+  auto &groups = get_state().groups;
+  tgroup &group = get_record(groups, id);
+  if (group.active == active)
+    return;
+
+  group.active = active;
+  history.record(get_state(), [&](tversion &version) {
+    version.groups = version.groups.set(
+        static_cast<std::size_t>(std::addressof(group) - groups.data()),
+        group);
+  });
+  notifier.notify(tchange{tentity::group, id, tattribute::active});
+}
+
+/** Returns the number of the current version of the state. */
+[[nodiscard]] std::size_t version() { return history.version(); }
+
+/**
+ * Returns the records changed since version @p since.
+ *
+ * Only the versions since the state was replaced, or its tasks moved, are
+ * available. The cost depends on the number of changes, not on the number
+ * of records.
+ */
+[[nodiscard]] std::optional<tchanges> changes_since(std::size_t since) {
+  const tversion *old = history.at(since);
+  if (since == history.version() && !old)
+    return tchanges{};
+  if (!old)
+    return {};
+
+  const tversion &current = *history.at(history.version());
+  tchanges result;
+  auto collect = [](const auto &lhs, const auto &rhs,
+                    std::vector<std::size_t> &ids) {
+    lhs.diff(rhs, [&](std::size_t index) { ids.push_back(rhs[index].id); });
+  };
+  collect(old->labels, current.labels, result.labels);
+  collect(old->projects, current.projects, result.projects);
+  collect(old->groups, current.groups, result.groups);
+  collect(old->tasks, current.tasks, result.tasks);
+  return result;
+}
+
+} // namespace data
+
+/**
+ * Makes the state match the version @p to, the state matches @p from.
+ *
+ * Only the fields changed through data can differ between the versions, the
+ * changed fields are copied and notified.
+ */
+static void restore(const tversion &from, const tversion &to) {
+  data::tstate &state = data::get_state();
+  from.tasks.diff(to.tasks, [&](std::size_t index) {
+    data::ttask &task = state.tasks[index];
+    if (task.status == to.tasks[index].status)
+      return;
+    task.status = to.tasks[index].status;
+    notifier.notify(data::tchange{data::tentity::task, task.id,
+                                  data::tattribute::status});
+  });
+  from.projects.diff(to.projects, [&](std::size_t index) {
+    data::tproject &project = state.projects[index];
+    if (project.active == to.projects[index].active)
+      return;
+    project.active = to.projects[index].active;
+    notifier.notify(data::tchange{data::tentity::project, project.id,
+                                  data::tattribute::active});
+  });
+  from.groups.diff(to.groups, [&](std::size_t index) {
+    data::tgroup &group = state.groups[index];
+    if (group.active == to.groups[index].active)
+      return;
+    group.active = to.groups[index].active;
+    notifier.notify(data::tchange{data::tentity::group, group.id,
+                                  data::tattribute::active});
+  });
+}
+
+/** Makes the previous, -1, or next, 1, version the current version. */
+static void step(int direction) {
+  const tversion &from = *history.at(history.version());
+  history.step(direction);
+  restore(from, *history.at(history.version()));
+}
+
+export namespace data {
+
+/** Undoes the last change, returns whether there was a change to undo. */
+bool undo() {
+  if (!history.can_undo())
+    return false;
+  step(-1);
+  return true;
+}
+
+/** Redoes the last undone change, returns whether there was one. */
+bool redo() {
+  if (!history.can_redo())
+    return false;
+  step(1);
+  return true;
+}
+
+/**
+ * The reverse dependencies of the tasks and groups.
+ *
+ * A task can only become blocked or unblocked when the status of a task it
+ * depends on, or of a task in a group it requires, changes. This index finds
+ * these tasks without visiting all tasks.
+ */
+class tdependents {
+public:
+  explicit tdependents(const tstate &state) {
+    std::unordered_map<std::size_t, std::size_t> projects;
+    for (const auto &group : state.groups)
+      projects.emplace(group.id, group.project);
+
+    for (const auto &task : state.tasks) {
+      for (auto id : task.dependencies)
+        tasks_[id].push_back(task.id);
+      for (auto id : task.requirements)
+        groups_[id].push_back(task.id);
+
+      if (task.project)
+        projects_[task.project].push_back(task.id);
+      if (task.group) {
+        members_[task.group].push_back(task.id);
+        projects_[projects.at(task.group)].push_back(task.id);
+      }
+    }
+  }
+
+  /**
+   * Returns the tasks whose blocked state depends on the status of @p task.
+   */
+  [[nodiscard]] std::vector<std::size_t> affected_by(const ttask &task) const {
+    std::vector<std::size_t> result;
+    if (auto iter = tasks_.find(task.id); iter != tasks_.end())
+      result.insert(result.end(), iter->second.begin(), iter->second.end());
+    if (auto iter = groups_.find(task.group);
+        task.group && iter != groups_.end())
+      result.insert(result.end(), iter->second.begin(), iter->second.end());
+
+    // A task can depend on both the task and its group.
+    std::ranges::sort(result);
+    auto duplicates = std::ranges::unique(result);
+    result.erase(duplicates.begin(), duplicates.end());
+    return result;
+  }
+
+  /**
+   * Returns the tasks whose active state depends on @p project.
+   *
+   * These are the tasks of the project and of its groups.
+   */
+  [[nodiscard]] std::vector<std::size_t>
+  members_of(const tproject &project) const {
+    std::vector<std::size_t> result;
+    if (auto iter = projects_.find(project.id); iter != projects_.end())
+      result = iter->second;
+    return result;
+  }
+
+  /** Returns the tasks whose active state depends on @p group. */
+  [[nodiscard]] std::vector<std::size_t> members_of(const tgroup &group) const {
+    std::vector<std::size_t> result;
+    if (auto iter = members_.find(group.id); iter != members_.end())
+      result = iter->second;
+    return result;
+  }
+
+private:
+  /** The tasks depending on a task, by the id of the task. */
+  std::unordered_map<std::size_t, std::vector<std::size_t>> tasks_{};
+  /** The tasks requiring a group, by the id of the group. */
+  std::unordered_map<std::size_t, std::vector<std::size_t>> groups_{};
+  /** The tasks of a project, including its groups, by id of the project. */
+  std::unordered_map<std::size_t, std::vector<std::size_t>> projects_{};
+  /** The tasks of a group, by the id of the group. */
+  std::unordered_map<std::size_t, std::vector<std::size_t>> members_{};
+};
+
+/**
+ * The ids of a merged board.
+ *
+ * When several boards are opened the ids of every board are namespaced by
+ * the index of the board, stored in the upper bits of the id. The ids of the
+ * first board are unchanged, so a single board behaves as before.
+ */
+inline constexpr std::size_t board_shift = 32;
+inline constexpr std::size_t max_board_id =
+    (std::size_t{1} << board_shift) - 1;
+
+/** The largest index of a board, the top bit of an id is board_reference. */
+inline constexpr std::size_t max_board =
+    (std::size_t{1} << (63 - board_shift)) - 1;
+
+/**
+ * Marks a reference to a record of another board.
+ *
+ * The dependencies and requirements of a task can refer to another board as
+ * board:id, with the index of the board. The parser stores these references
+ * as the namespaced id with this bit set, resolve_references validates them
+ * after merging the boards and clears the bit.
+ */
+inline constexpr std::size_t board_reference = std::size_t{1} << 63;
+
+/** Returns the id of @p id in @p board, 0 stays the value for "no record". */
+[[nodiscard]] constexpr std::size_t board_id(std::size_t board,
+                                             std::size_t id) {
+  return id == 0 ? 0 : id | (board << board_shift);
+}
+
+/** Returns the index of the board containing the record with @p id. */
+[[nodiscard]] constexpr std::size_t board_of(std::size_t id) {
+  return id >> board_shift;
+}
+
+/**
+ * Returns @p id as shown to the user, when @p boards are loaded.
+ *
+ * When several boards are loaded the id of a record of another board than
+ * the first is shown as board:id, the syntax of a reference to it.
+ */
+[[nodiscard]] std::string format_id(std::size_t id, std::size_t boards) {
+  if (boards == 1 || board_of(id) == 0)
+    return std::format("{}", id);
+  return std::format("{}:{}", board_of(id), id & max_board_id);
+}
+
+/** Returns @p id as shown to the user, see tstate::boards. */
+[[nodiscard]] std::string format_id(std::size_t id) {
+  return format_id(id, get_state().boards);
+}
+
+/**
+ * Namespaces the ids of @p state and its references by @p board.
+ *
+ * @param boards The number of boards loaded, a single board keeps its ids.
+ *
+ * Returns false when an id is too large to be namespaced, the state is
+ * partially modified then. This applies to the first board as well, its ids
+ * would overlap the ids of the other boards.
+ */
+[[nodiscard]] bool namespace_ids(tstate &state, std::size_t board,
+                                 std::size_t boards) {
+  if (boards == 1)
+    return true;
+
+  bool result = true;
+  auto update = [&](std::size_t &id) {
+    // Already namespaced by the parser, see resolve_references.
+    if (id & board_reference)
+      return;
+    result = result && id <= max_board_id;
+    id = board_id(board, id);
+  };
+  auto update_all = [&](std::pmr::vector<std::size_t> &ids) {
+    std::ranges::for_each(ids, update);
+  };
+
+  for (auto &label : state.labels)
+    update(label.id);
+  for (auto &project : state.projects)
+    update(project.id);
+  for (auto &group : state.groups) {
+    update(group.id);
+    update(group.project);
+  }
+  auto update_tasks = [&](std::pmr::vector<ttask> &tasks) {
+    for (auto &task : tasks) {
+      update(task.id);
+      update(task.project);
+      update(task.group);
+      update_all(task.labels);
+      update_all(task.dependencies);
+      update_all(task.requirements);
+    }
+  };
+  update_tasks(state.tasks);
+  update_tasks(state.archive);
+  update_all(state.archived);
+  return result;
+}
+
+/**
+ * Merges @p states, in order, into one state.
+ *
+ * The ids of the states should be namespaced with namespace_ids. The records
+ * are moved, not copied, and the merged state owns the arenas of all states.
+ */
+[[nodiscard]] std::unique_ptr<tstate>
+merge(std::vector<std::unique_ptr<tstate>> states) {
+  trace::tspan span{"data::merge"};
+
+  if (states.empty())
+    return std::make_unique<tstate>();
+
+  std::unique_ptr<tstate> result = std::move(states.front());
+  auto others = states | std::views::drop(1);
+  auto reserve = [&](auto member) {
+    std::size_t size = ((*result).*member).size();
+    for (const auto &state : others)
+      size += ((*state).*member).size();
+    ((*result).*member).reserve(size);
+  };
+  reserve(&tstate::labels);
+  reserve(&tstate::projects);
+  reserve(&tstate::groups);
+  reserve(&tstate::tasks);
+  reserve(&tstate::archived);
+  reserve(&tstate::archive);
+
+  for (auto &state : others) {
+    std::ranges::move(state->labels, std::back_inserter(result->labels));
+    std::ranges::move(state->projects, std::back_inserter(result->projects));
+    std::ranges::move(state->groups, std::back_inserter(result->groups));
+    std::ranges::move(state->tasks, std::back_inserter(result->tasks));
+    std::ranges::move(state->archived,
+                      std::back_inserter(result->archived));
+    std::ranges::move(state->archive, std::back_inserter(result->archive));
+    result->archive_loaded = result->archive_loaded && state->archive_loaded;
+    ++result->boards;
+    if (state->arena)
+      result->merged_arenas.emplace_back(std::move(state->arena));
+    std::ranges::move(state->merged_arenas,
+                      std::back_inserter(result->merged_arenas));
+  }
+  // is_archived relies on the order.
+  std::ranges::sort(result->archived);
+  return result;
 }
 
-bool is_active(const data::ttask &task) {
-  if (task.project != 0)
-    return get_project(task.project).active;
+/**
+ * Resolves the references to other boards in the merged @p state.
+ *
+ * The parser validates the references within a board, the references to
+ * another board can only be validated after merging, see board_reference.
+ * The archived tasks are not validated, their references were validated
+ * before they were archived.
+ *
+ * Returns the error, if any.
+ */
+[[nodiscard]] std::optional<std::string> resolve_references(tstate &state) {
+  trace::tspan span{"data::resolve_references"};
 
-  if (task.group == 0)
-    return true;
+  auto resolve = [&](const ttask &task, std::size_t &id, std::string_view field,
+                     auto exists) -> std::optional<std::string> {
+    if (!(id & board_reference))
+      return {};
 
-  data::tgroup group = get_group(task.group);
-  return group.active && get_project(group.project).active;
+    id &= ~board_reference;
+    if (board_of(id) >= state.boards)
+      return std::format(
+          "task »{}« refers to board {} in field »{}«, which is not loaded",
+          format_id(task.id, state.boards), board_of(id), field);
+    if (!exists(id))
+      return std::format("id field »{}« of task »{}« has no linked record "
+                         "for value »{}«",
+                         field, format_id(task.id, state.boards),
+                         format_id(id, state.boards));
+    return {};
+  };
+  auto task_exists = [&](std::size_t id) {
+    return std::ranges::binary_search(state.archived, id) ||
+           find_record(state.tasks, id) != nullptr;
+  };
+  auto group_exists = [&](std::size_t id) {
+    return find_record(state.groups, id) != nullptr;
+  };
+
+  for (auto &task : state.tasks) {
+    for (auto &id : task.dependencies)
+      if (auto error = resolve(task, id, "dependencies", task_exists))
+        return error;
+    for (auto &id : task.requirements)
+      if (auto error = resolve(task, id, "requirements", group_exists))
+        return error;
+  }
+  return {};
 }
 
 } // namespace data
 
+/**
+ * A line of the input.
+ *
+ * The line numbers are only needed for errors, so the parser tracks byte
+ * offsets and the number is computed when the line is converted to an int.
+ */
+class tline {
+public:
+  /**
+   * @param data The input, or a part of the input starting at line @p first.
+   * @param offset The offset of the line in @p data.
+   */
+  tline(std::string_view data, std::size_t offset, int first)
+      : data_(data), offset_(offset), first_(first) {}
+
+  /** The conversion is implicit, so the line is used like a line number. */
+  operator int() const {
+    // The compilers vectorize counting the bytes.
+    int result = first_ + static_cast<int>(std::ranges::count(
+                              data_.substr(0, offset_), '\n'));
+    // The parser counts a last line without a newline as a complete line.
+    if (offset_ == data_.size() && !data_.empty() && !data_.ends_with('\n'))
+      ++result;
+    return result;
+  }
+
+private:
+  std::string_view data_;
+  std::size_t offset_;
+  int first_;
+};
+
 class parser {
 public:
   struct tresult {
@@ -194,8 +1154,14 @@ public:
     std::array<std::string_view, 2> data;
   };
 
-  explicit parser(std::string_view data)
-      : data_(data), next_{data.begin(), 1} {}
+  /**
+   * @param data The input, or a part of the input starting at @p line.
+   * @param references Whether the records validate their references. When
+   * not set the references are checked after parsing, see data::validate.
+   */
+  explicit parser(std::string_view data, int line = 1, bool references = true)
+      : data_(data), first_line_(line), next_{data.begin()},
+        references_(references) {}
 
   std::expected<tresult, data::tparse_error> parse() {
 
@@ -207,7 +1173,6 @@ public:
     switch (*current_.cursor_) {
     case '\n':
       ++next_.cursor_;
-      ++next_.line_;
       return tresult{tresult::empty, {}};
 
     case '[':
@@ -217,14 +1182,20 @@ public:
     return parse_value();
   }
 
-  int line() const { return current_.line_; }
+  /** Returns the line being processed, the line is computed lazily. */
+  tline position() const {
+    return tline{data_,
+                 static_cast<std::size_t>(current_.cursor_ - data_.begin()),
+                 first_line_};
+  }
+  int line() const { return position(); }
+  bool references() const { return references_; }
 
 private:
   std::expected<tresult, data::tparse_error> parse_header() {
     auto end = std::find(current_.cursor_ + 1, data_.end(), '\n');
 
     next_.cursor_ = end + (end != data_.end());
-    ++next_.line_;
 
     return tresult{tresult::header,
                    {std::string_view{current_.cursor_, end}, {}}};
@@ -235,9 +1206,8 @@ private:
     auto separator = std::find(current_.cursor_ + 1, data_.end(), '=');
     if (separator == data_.end()) {
       next_.cursor_ = data_.end();
-      next_.line_ = -1;
       return std::unexpected<data::tparse_error>{
-          std::in_place, current_.line_,
+          std::in_place, line(),
           std::string_view{current_.cursor_, data_.end()},
           "value contains no '=' separator"};
     }
@@ -250,23 +1220,20 @@ private:
       // multiline value
       if (end == data_.end()) {
         next_.cursor_ = data_.end();
-        next_.line_ = -1;
         return std::unexpected<data::tparse_error>{
-            std::in_place, current_.line_,
+            std::in_place, line(),
             std::string_view{current_.cursor_, data_.end()},
             "value ends with start of multiline marker"};
       }
       begin = end + 1;
-      ++next_.line_;
 
       while (true) {
         auto pos = end + 1;
         end = std::find(pos, data_.end(), '\n');
         if (end == data_.end()) {
           next_.cursor_ = data_.end();
-          next_.line_ = -1;
           return std::unexpected<data::tparse_error>{
-              std::in_place, current_.line_,
+              std::in_place, line(),
               std::string_view{current_.cursor_, data_.end()},
               "end of file before multiline terminator was found"};
         }
@@ -275,13 +1242,9 @@ private:
           value = std::string_view{begin, pos - 1};
           break;
         }
-
-        ++next_.line_;
       }
-      // The last line is not "counted" since it always counts one line.
     }
 
-    ++next_.line_;
     next_.cursor_ = end + (end != data_.end());
 
     return tresult{tresult::pair,
@@ -289,13 +1252,13 @@ private:
   }
 
   std::string_view data_{};
+  /** The line number of the start of data_. */
+  int first_line_;
 
   /** The state of the parser. */
   struct state {
     /** The position to start processing. */
     std::string_view::iterator cursor_;
-    /** The line being processed. */
-    int line_{1};
   };
 
   /**
@@ -309,9 +1272,11 @@ private:
    * Updated during parsing.
    *
    * The state at the end is the start state for the next parse cycle.
-   * When an error occurred the line is set ot -1.
+   * When an error occurred the cursor is set to the end.
    */
   state next_;
+
+  bool references_;
 };
 
 enum class tfield_type { id, string, color, boolean, status, date, id_list };
@@ -326,7 +1291,8 @@ struct tid {
 };
 
 struct tstring {
-  std::optional<std::string> value;
+  /** The value refers to the input, the record copies it to the arena. */
+  std::optional<std::string_view> value;
 };
 
 struct tcolor {
@@ -347,9 +1313,11 @@ struct tdate {
 
 struct tid_list {
   enum class ttarget { label, project, group, task };
-  std::optional<std::vector<std::size_t>> value{};
+  std::optional<std::pmr::vector<std::size_t>> value{};
   ttarget target;
   bool self;
+  /** Whether the ids may refer to another board, see data::board_reference. */
+  bool boards{false};
 };
 
 struct tfield {
@@ -360,7 +1328,7 @@ struct tfield {
 };
 
 std::optional<data::tparse_error>
-parse_id(tfield &field, std::string_view input, int line_no) {
+parse_id(tfield &field, std::string_view input, tline line_no) {
   auto &id = std::get<tid>(field.value);
   if (id.value)
     return std::optional<data::tparse_error>{
@@ -391,7 +1359,7 @@ parse_id(tfield &field, std::string_view input, int line_no) {
 }
 
 std::optional<data::tparse_error>
-parse_string(tfield &field, std::string_view input, int line_no) {
+parse_string(tfield &field, std::string_view input, tline line_no) {
   auto &string = std::get<tstring>(field.value);
   if (string.value)
     return std::optional<data::tparse_error>{
@@ -409,7 +1377,7 @@ parse_string(tfield &field, std::string_view input, int line_no) {
 }
 
 std::optional<data::tparse_error>
-parse_color(tfield &field, std::string_view input, int line_no) {
+parse_color(tfield &field, std::string_view input, tline line_no) {
   auto &color = std::get<tcolor>(field.value);
   if (color.value)
     return std::optional<data::tparse_error>{
@@ -423,22 +1391,18 @@ parse_color(tfield &field, std::string_view input, int line_no) {
                     "field »{}«",
                     field.name)};
 
-  constexpr std::array<std::string_view, 16> color_names{
-      "black", "RED", "GREEN", "YELLOW", "BLUE", "MAGENTA", "CYAN", "gray",
-      "GRAY",  "red", "green", "yellow", "blue", "magenta", "cyan", "white"};
-
-  auto iter = std::ranges::find(color_names, input);
-  if (iter == color_names.end())
+  auto iter = std::ranges::find(data::color_names, input);
+  if (iter == data::color_names.end())
     return std::optional<data::tparse_error>{
         std::in_place, line_no, input,
         std::format("invalid color value for field »{}«", field.name)};
 
-  color.value = static_cast<data::tcolor>(iter - color_names.begin());
+  color.value = static_cast<data::tcolor>(iter - data::color_names.begin());
   return {};
 }
 
 std::optional<data::tparse_error>
-parse_boolean(tfield &field, std::string_view input, int line_no) {
+parse_boolean(tfield &field, std::string_view input, tline line_no) {
   auto &boolean = std::get<tboolean>(field.value);
   if (boolean.value)
     return std::optional<data::tparse_error>{
@@ -458,7 +1422,7 @@ parse_boolean(tfield &field, std::string_view input, int line_no) {
 }
 
 std::optional<data::tparse_error>
-parse_status(tfield &field, std::string_view input, int line_no) {
+parse_status(tfield &field, std::string_view input, tline line_no) {
   auto &status = std::get<tstatus>(field.value);
   if (status.value)
     return std::optional<data::tparse_error>{
@@ -486,7 +1450,7 @@ parse_status(tfield &field, std::string_view input, int line_no) {
 }
 
 std::optional<data::tparse_error>
-parse_date(tfield &field, std::string_view input, int line_no) {
+parse_date(tfield &field, std::string_view input, tline line_no) {
   auto &date = std::get<tdate>(field.value);
   if (date.value)
     return std::optional<data::tparse_error>{
@@ -556,14 +1520,15 @@ parse_date(tfield &field, std::string_view input, int line_no) {
 }
 
 std::optional<data::tparse_error>
-parse_id_list(tfield &field, std::string_view input, int line_no) {
+parse_id_list(tfield &field, std::string_view input, tline line_no,
+              std::pmr::memory_resource *resource) {
   auto &id_list = std::get<tid_list>(field.value);
   if (id_list.value)
     return std::optional<data::tparse_error>{
         std::in_place, line_no, input,
         std::format("duplicate entry for field »{}«", field.name)};
 
-  std::vector<std::size_t> result;
+  std::pmr::vector<std::size_t> result{resource};
   std::string_view data = input;
   while (!data.empty()) {
     if (data[0] == ' ') {
@@ -573,6 +1538,23 @@ parse_id_list(tfield &field, std::string_view input, int line_no) {
 
     const char *end = std::find(data.data(), data.data() + data.size(), ',');
 
+    // A reference to another board, board:id.
+    std::optional<std::size_t> board;
+    if (const char *separator = std::find(data.data(), end, ':');
+        id_list.boards && separator != end) {
+      std::size_t index;
+      std::from_chars_result status =
+          std::from_chars(data.data(), separator, index);
+      if (status.ec != std::errc{} || status.ptr != separator ||
+          index > data::max_board)
+        return std::optional<data::tparse_error>{
+            std::in_place, line_no, input,
+            std::format("invalid board for field »{}«", field.name)};
+
+      board = index;
+      data = std::string_view{separator + 1, data.data() + data.size()};
+    }
+
     std::size_t value;
     std::from_chars_result status = std::from_chars(data.data(), end, value);
     if (status.ec != std::errc{})
@@ -591,6 +1573,16 @@ parse_id_list(tfield &field, std::string_view input, int line_no) {
           std::format("zero is not a valid value for an id list field »{}«",
                       field.name)};
 
+    if (board) {
+      if (value > data::max_board_id)
+        return std::optional<data::tparse_error>{
+            std::in_place, line_no, input,
+            std::format("id too large for a reference to another board for "
+                        "field »{}«",
+                        field.name)};
+      value = data::board_reference | data::board_id(*board, value);
+    }
+
     result.push_back(value);
     if (end == data.data() + data.size())
       break;
@@ -603,7 +1595,8 @@ parse_id_list(tfield &field, std::string_view input, int line_no) {
 }
 
 std::optional<data::tparse_error>
-parse_element(tfield &field, std::string_view input, int line_no) {
+parse_element(tfield &field, std::string_view input, tline line_no,
+              std::pmr::memory_resource *resource) {
   switch (field.type) {
   case tfield_type::id:
     return parse_id(field, input, line_no);
@@ -618,7 +1611,7 @@ parse_element(tfield &field, std::string_view input, int line_no) {
   case tfield_type::date:
     return parse_date(field, input, line_no);
   case tfield_type::id_list:
-    return parse_id_list(field, input, line_no);
+    return parse_id_list(field, input, line_no, resource);
   }
 }
 
@@ -627,7 +1620,7 @@ parse_element(tfield &field, std::string_view input, int line_no) {
 template <class Container, class Projection, class T>
 std::optional<data::tparse_error>
 validate_unique(const Container &container, Projection projection,
-                const T &value, std::string_view field, int line_no)
+                const T &value, std::string_view field, tline line_no)
 
 {
 #if 0
@@ -648,7 +1641,7 @@ validate_unique(const Container &container, Projection projection,
 template <class Container, class Projection, class T>
 std::optional<data::tparse_error>
 validate_exists(const Container &container, Projection projection,
-                const T &value, std::string_view field, int line_no) {
+                const T &value, std::string_view field, tline line_no) {
 #if 0
   // Contains hasn't been implemented yet.
   if (std::ranges::contains(container, value, projection))
@@ -665,8 +1658,9 @@ validate_exists(const Container &container, Projection projection,
                   value)};
 }
 
-std::optional<data::tparse_error>
-validate_id(const tfield &field, const data::tstate &state, int line_no) {
+std::optional<data::tparse_error> validate_id(const tfield &field,
+                                              const data::tstate &state,
+                                              tline line_no, bool references) {
 
   const auto &id = std::get<tid>(field.value);
   if (!id.value || *id.value == 0)
@@ -676,7 +1670,9 @@ validate_id(const tfield &field, const data::tstate &state, int line_no) {
                      std::in_place, line_no, "",
                      std::format("missing mandatory field »{}«", field.name)};
 
-  std::optional<data::tparse_error> result;
+  if (!references)
+    return {};
+
   switch (id.target) {
   case tid::ttarget::label:
     return id.self ? validate_unique(state.labels, &data::tlabel::id, *id.value,
@@ -705,7 +1701,7 @@ validate_id(const tfield &field, const data::tstate &state, int line_no) {
 }
 
 std::optional<data::tparse_error> validate_string(const tfield &field,
-                                                  int line_no) {
+                                                  tline line_no) {
   const auto &string = std::get<tstring>(field.value);
   if (field.requirement == tfield_requirement::mandatory && !string.value)
     return std::optional<data::tparse_error>{
@@ -716,7 +1712,7 @@ std::optional<data::tparse_error> validate_string(const tfield &field,
 }
 
 std::optional<data::tparse_error> validate_color(const tfield &field,
-                                                 int line_no) {
+                                                 tline line_no) {
   const auto &color = std::get<tcolor>(field.value);
   if (field.requirement == tfield_requirement::mandatory && !color.value)
     return std::optional<data::tparse_error>{
@@ -727,7 +1723,7 @@ std::optional<data::tparse_error> validate_color(const tfield &field,
 }
 
 std::optional<data::tparse_error> validate_boolean(const tfield &field,
-                                                   int line_no) {
+                                                   tline line_no) {
   const auto &boolean = std::get<tboolean>(field.value);
   if (field.requirement == tfield_requirement::mandatory && !boolean.value)
     return std::optional<data::tparse_error>{
@@ -738,7 +1734,7 @@ std::optional<data::tparse_error> validate_boolean(const tfield &field,
 }
 
 std::optional<data::tparse_error> validate_status(const tfield &field,
-                                                  int line_no) {
+                                                  tline line_no) {
   const auto &status = std::get<tstatus>(field.value);
   if (field.requirement == tfield_requirement::mandatory && !status.value)
     return std::optional<data::tparse_error>{
@@ -749,7 +1745,7 @@ std::optional<data::tparse_error> validate_status(const tfield &field,
 }
 
 std::optional<data::tparse_error> validate_date(const tfield &field,
-                                                int line_no) {
+                                                tline line_no) {
   const auto &date = std::get<tdate>(field.value);
   if (field.requirement == tfield_requirement::mandatory && !date.value)
     return std::optional<data::tparse_error>{
@@ -759,8 +1755,10 @@ std::optional<data::tparse_error> validate_date(const tfield &field,
   return {};
 }
 
-std::optional<data::tparse_error>
-validate_id_list(const tfield &field, const data::tstate &state, int line_no) {
+std::optional<data::tparse_error> validate_id_list(const tfield &field,
+                                                   const data::tstate &state,
+                                                   tline line_no,
+                                                   bool references) {
   const auto &id_list = std::get<tid_list>(field.value);
 
   if (!id_list.value || id_list.value->empty()) {
@@ -772,7 +1770,7 @@ validate_id_list(const tfield &field, const data::tstate &state, int line_no) {
       return {};
   }
 
-  if (id_list.self)
+  if (id_list.self || !references)
     return {};
 
   switch (id_list.target) {
@@ -796,6 +1794,9 @@ validate_id_list(const tfield &field, const data::tstate &state, int line_no) {
 
   case tid_list::ttarget::group:
     for (const auto value : *id_list.value) {
+      // Validated after merging the boards.
+      if (value & data::board_reference)
+        continue;
       std::optional<data::tparse_error> error = validate_exists(
           state.groups, &data::tgroup::id, value, field.name, line_no);
       if (error)
@@ -816,12 +1817,14 @@ validate_id_list(const tfield &field, const data::tstate &state, int line_no) {
   return {};
 }
 
-std::optional<data::tparse_error>
-validate_field(const tfield &field, const data::tstate &state, int line_no) {
+std::optional<data::tparse_error> validate_field(const tfield &field,
+                                                 const data::tstate &state,
+                                                 tline line_no,
+                                                 bool references) {
 
   switch (field.type) {
   case tfield_type::id:
-    return validate_id(field, state, line_no);
+    return validate_id(field, state, line_no, references);
   case tfield_type::string:
     return validate_string(field, line_no);
   case tfield_type::color:
@@ -833,7 +1836,7 @@ validate_field(const tfield &field, const data::tstate &state, int line_no) {
   case tfield_type::date:
     return validate_date(field, line_no);
   case tfield_type::id_list:
-    return validate_id_list(field, state, line_no);
+    return validate_id_list(field, state, line_no, references);
   }
 }
 /// *** PARSE
@@ -841,8 +1844,10 @@ validate_field(const tfield &field, const data::tstate &state, int line_no) {
 std::optional<data::tparse_error>
 parse_record(data::tstate &state, parser &parser, std::span<tfield> fields) {
 
+  trace::tspan span{"parse_record"};
+
   // *** PARSE ***
-  int line_number = parser.line();
+  tline line_number = parser.position();
   bool done = false;
   do {
 
@@ -875,7 +1880,8 @@ parse_record(data::tstate &state, parser &parser, std::span<tfield> fields) {
             "invalid field name"};
 
       std::optional<data::tparse_error> error =
-          parse_element(*iter, line->data[1], parser.line());
+          parse_element(*iter, line->data[1], parser.position(),
+                        state.tasks.get_allocator().resource());
 
       if (error)
         return error;
@@ -885,9 +1891,11 @@ parse_record(data::tstate &state, parser &parser, std::span<tfield> fields) {
 
   // *** VALIDATE ***
 
+  trace::tspan validate_span{"parse_record::validate"};
+
   for (const auto &field : fields) {
     std::optional<data::tparse_error> error =
-        validate_field(field, state, line_number);
+        validate_field(field, state, line_number, parser.references());
     if (error)
       return error;
   }
@@ -912,10 +1920,13 @@ std::optional<data::tparse_error> parse_label(data::tstate &state,
   if (error)
     return *error;
 
+  std::pmr::memory_resource *resource = state.labels.get_allocator().resource();
   state.labels.emplace_back(
       std::get<tid>(record[0].value).value.value(),
-      std::get<tstring>(record[1].value).value.value(),
-      std::get<tstring>(record[2].value).value.value_or(""),
+      std::pmr::string{std::get<tstring>(record[1].value).value.value(),
+                       resource},
+      std::pmr::string{std::get<tstring>(record[2].value).value.value_or(""),
+                       resource},
       std::get<tcolor>(record[3].value).value.value_or(data::tcolor::black));
 
   return {};
@@ -940,10 +1951,14 @@ std::optional<data::tparse_error> parse_project(data::tstate &state,
   if (error)
     return *error;
 
+  std::pmr::memory_resource *resource =
+      state.projects.get_allocator().resource();
   state.projects.emplace_back(
       std::get<tid>(record[0].value).value.value(),
-      std::get<tstring>(record[1].value).value.value(),
-      std::get<tstring>(record[2].value).value.value_or(""),
+      std::pmr::string{std::get<tstring>(record[1].value).value.value(),
+                       resource},
+      std::pmr::string{std::get<tstring>(record[2].value).value.value_or(""),
+                       resource},
       std::get<tcolor>(record[3].value).value.value_or(data::tcolor::black),
       std::get<tboolean>(record[4].value).value.value_or(true));
 
@@ -971,11 +1986,14 @@ std::optional<data::tparse_error> parse_group(data::tstate &state,
   if (error)
     return *error;
 
+  std::pmr::memory_resource *resource = state.groups.get_allocator().resource();
   state.groups.emplace_back(
       std::get<tid>(record[0].value).value.value(),
       std::get<tid>(record[1].value).value.value(),
-      std::get<tstring>(record[2].value).value.value(),
-      std::get<tstring>(record[3].value).value.value_or(""),
+      std::pmr::string{std::get<tstring>(record[2].value).value.value(),
+                       resource},
+      std::pmr::string{std::get<tstring>(record[3].value).value.value_or(""),
+                       resource},
       std::get<tcolor>(record[4].value).value.value_or(data::tcolor::black),
       std::get<tboolean>(record[5].value).value.value_or(true));
 
@@ -984,7 +2002,7 @@ std::optional<data::tparse_error> parse_group(data::tstate &state,
 
 std::optional<data::tparse_error> parse_task(data::tstate &state,
                                              parser &parser) {
-  int line = parser.line();
+  tline line = parser.position();
 
   std::array record{
       tfield{"id", tfield_type::id, tfield_requirement::mandatory,
@@ -1003,9 +2021,13 @@ std::optional<data::tparse_error> parse_task(data::tstate &state,
       tfield{"labels", tfield_type::id_list, tfield_requirement::optional,
              tid_list{.target = tid_list::ttarget::label, .self = false}},
       tfield{"dependencies", tfield_type::id_list, tfield_requirement::optional,
-             tid_list{.target = tid_list::ttarget::task, .self = true}},
+             tid_list{.target = tid_list::ttarget::task,
+                      .self = true,
+                      .boards = true}},
       tfield{"requirements", tfield_type::id_list, tfield_requirement::optional,
-             tid_list{.target = tid_list::ttarget::group, .self = false}},
+             tid_list{.target = tid_list::ttarget::group,
+                      .self = false,
+                      .boards = true}},
   };
 
   std::optional<data::tparse_error> error = parse_record(state, parser, record);
@@ -1021,25 +2043,46 @@ std::optional<data::tparse_error> parse_task(data::tstate &state,
         std::in_place, line, "",
         std::format("task »{}« has both a »group« and a »project« set", id)};
 
+  // The id lists are moved, copying them would not preserve the arena.
+  std::pmr::memory_resource *resource = state.tasks.get_allocator().resource();
   state.tasks.emplace_back(
       id,      //
       project, //
       group,   //
-      std::get<tstring>(record[3].value).value.value(),
-      std::get<tstring>(record[4].value).value.value_or(""),
+      std::pmr::string{std::get<tstring>(record[3].value).value.value(),
+                       resource},
+      std::pmr::string{std::get<tstring>(record[4].value).value.value_or(""),
+                       resource},
       std::get<tstatus>(record[5].value)
           .value.value_or(data::ttask::tstatus::backlog),
       std::get<tdate>(record[6].value).value, // the target type is an optional
-      std::get<tid_list>(record[7].value)
-          .value.value_or(std::vector<std::size_t>{}),
-      std::get<tid_list>(record[8].value)
-          .value.value_or(std::vector<std::size_t>{}),
-      std::get<tid_list>(record[9].value)
-          .value.value_or(std::vector<std::size_t>{}));
+      std::move(std::get<tid_list>(record[7].value).value)
+          .value_or(std::pmr::vector<std::size_t>{resource}),
+      std::move(std::get<tid_list>(record[8].value).value)
+          .value_or(std::pmr::vector<std::size_t>{resource}),
+      std::move(std::get<tid_list>(record[9].value).value)
+          .value_or(std::pmr::vector<std::size_t>{resource}));
 
   return {};
 }
 
+std::optional<data::tparse_error> parse_archived(data::tstate &state,
+                                                 parser &parser) {
+  std::array record{
+      tfield{"ids", tfield_type::id_list, tfield_requirement::mandatory,
+             tid_list{.target = tid_list::ttarget::task, .self = true}},
+  };
+
+  std::optional<data::tparse_error> error = parse_record(state, parser, record);
+  if (error)
+    return *error;
+
+  // The ids are sorted when the input is parsed.
+  const auto &ids = *std::get<tid_list>(record[0].value).value;
+  state.archived.insert(state.archived.end(), ids.begin(), ids.end());
+  return {};
+}
+
 std::optional<data::tparse_error>
 parse_header(data::tstate &state, parser &parser, std ::string_view header) {
   if (header == "[label]")
@@ -1050,6 +2093,8 @@ parse_header(data::tstate &state, parser &parser, std ::string_view header) {
     return parse_group(state, parser);
   if (header == "[task]")
     return parse_task(state, parser);
+  if (header == "[archive]")
+    return parse_archived(state, parser);
 
   return data::tparse_error{parser.line(), header, "found unknown header"};
 }
@@ -1063,7 +2108,21 @@ export namespace data {
  */
 [[nodiscard]] std::expected<std::unique_ptr<tstate>, tparse_error>
 parse(std::string_view input) {
-  auto state = std::make_unique<tstate>();
+  trace::tspan span{"data::parse"};
+
+  // The records are about the size of the input, so the initial buffer avoids
+  // most of the growth of the arena.
+  auto arena = std::make_unique<std::pmr::monotonic_buffer_resource>(
+      std::max(input.size(), std::size_t{4096}));
+  std::pmr::memory_resource *resource = arena.get();
+  auto state = std::make_unique<tstate>(
+      tstate{.arena = std::move(arena),
+             .labels = std::pmr::vector<tlabel>(resource),
+             .projects = std::pmr::vector<tproject>(resource),
+             .groups = std::pmr::vector<tgroup>(resource),
+             .tasks = std::pmr::vector<ttask>(resource),
+             .archived = std::pmr::vector<std::size_t>(resource),
+             .archive = std::pmr::vector<ttask>(resource)});
 
   parser parser(input);
   while (true) {
@@ -1074,8 +2133,18 @@ parse(std::string_view input) {
       return std::unexpected{line.error()};
 
     switch (line->type) {
-    case parser::tresult::eof:
+    case parser::tresult::eof: {
+      std::ranges::sort(state->archived);
+      auto duplicates = std::ranges::unique(state->archived);
+      state->archived.erase(duplicates.begin(), duplicates.end());
+      for (const auto &task : state->tasks)
+        if (std::ranges::binary_search(state->archived, task.id))
+          return std::unexpected<tparse_error>{
+              std::in_place, parser.line(), "",
+              std::format("task »{}« is both active and archived", task.id)};
+
       return std::move(state);
+    }
 
     case parser::tresult::empty:
       /* DO NOTHING */
@@ -1101,4 +2170,610 @@ parse(std::string_view input) {
   // std::unreachable();
 }
 
+/**
+ * Parses the archive of board @p board of @p state.
+ *
+ * The archive contains the archived tasks, in the input format. The tasks are
+ * validated against the labels, projects, and groups of their board and
+ * added to tstate::archive.
+ *
+ * Returns the error, if any.
+ */
+[[nodiscard]] std::optional<tparse_error>
+parse_archive(tstate &state, std::string_view input, std::size_t board) {
+  trace::tspan span{"data::parse_archive"};
+
+  // The records of the board with the ids of its input, the references of
+  // the archived tasks are validated against these. The tasks are allocated
+  // like the other tasks of the state.
+  auto local = [](std::size_t id) { return id & max_board_id; };
+  tstate scratch{
+      .tasks = std::pmr::vector<ttask>(state.tasks.get_allocator().resource())};
+  for (const auto &label : state.labels)
+    if (board_of(label.id) == board)
+      scratch.labels.push_back(tlabel{.id = local(label.id), .name = {}});
+  for (const auto &project : state.projects)
+    if (board_of(project.id) == board)
+      scratch.projects.push_back(
+          tproject{.id = local(project.id), .name = {}});
+  for (const auto &group : state.groups)
+    if (board_of(group.id) == board)
+      scratch.groups.push_back(tgroup{.id = local(group.id), .name = {}});
+
+  parser parser(input);
+  while (true) {
+    std::expected<parser::tresult, tparse_error> line = parser.parse();
+    if (!line)
+      return line.error();
+
+    if (line->type == parser::tresult::eof)
+      break;
+    if (line->type == parser::tresult::empty)
+      continue;
+    if (line->type == parser::tresult::pair)
+      return tparse_error{
+          parser.line(),
+          std::string_view{line->data[0].begin(), line->data[1].end()},
+          "value is not attached to a header"};
+    if (line->data[0] != "[task]")
+      return tparse_error{parser.line(), line->data[0],
+                          "the archive only contains tasks"};
+
+    if (std::optional<tparse_error> error = parse_task(scratch, parser))
+      return error;
+  }
+
+  if (!namespace_ids(scratch, board, state.boards))
+    return tparse_error{parser.line(), "", "id too large for a merged board"};
+
+  // The references to other boards were validated before the tasks were
+  // archived.
+  for (auto &task : scratch.tasks) {
+    for (auto &id : task.dependencies)
+      id &= ~board_reference;
+    for (auto &id : task.requirements)
+      id &= ~board_reference;
+  }
+
+  // The archive is written before the board, a task that is not archived was
+  // left behind when writing the board failed.
+  for (auto &task : scratch.tasks)
+    if (std::ranges::binary_search(state.archived, task.id))
+      state.archive.push_back(std::move(task));
+  return {};
+}
+
+/**
+ * Moves the done and discarded tasks of @p state to its archive.
+ *
+ * The archive should be loaded, the archived tasks are written with the
+ * loaded archive. This invalidates the pointers to the tasks of @p state.
+ *
+ * Returns the number of archived tasks.
+ */
+std::size_t archive(tstate &state) {
+  trace::tspan span{"data::archive"};
+
+  auto complete = std::ranges::stable_partition(
+      state.tasks, [](const ttask &task) { return !is_complete(task); });
+  std::size_t result = complete.size();
+  for (auto &task : complete) {
+    state.archived.push_back(task.id);
+    state.archive.push_back(std::move(task));
+  }
+  state.tasks.erase(complete.begin(), complete.end());
+  std::ranges::sort(state.archived);
+
+  // The tasks of the current state have moved.
+  if (std::addressof(state) == std::addressof(get_state())) {
+    ++state_generation_counter;
+    history.clear();
+  }
+  return result;
+}
+
+/** The memory of a kind of object. */
+struct tmemory {
+  /** The number of objects. */
+  std::size_t count{0};
+  /** The bytes in use. */
+  std::size_t size{0};
+  /** The bytes allocated, including the unused capacity. */
+  std::size_t capacity{0};
+
+  tmemory &operator+=(const tmemory &other) {
+    count += other.count;
+    size += other.size;
+    capacity += other.capacity;
+    return *this;
+  }
+};
+
+/**
+ * The memory of a tstate, by category.
+ *
+ * The records, strings, and id lists of a parsed state are allocated in its
+ * arena. The arena never frees memory, so the buffers left behind when a
+ * vector or string grows are not included.
+ */
+struct tmemory_usage {
+  /** The records in the record vectors. */
+  tmemory records{};
+  /** The strings, only long strings have a buffer outside their record. */
+  tmemory strings{};
+  /** The ids in the id lists of the tasks. */
+  tmemory ids{};
+  /** The archived ids and the records of the loaded archive. */
+  tmemory archive{};
+};
+
+/** Returns the memory used by @p state. */
+[[nodiscard]] tmemory_usage memory_usage(const tstate &state) {
+  auto vector = []<class T>(const std::pmr::vector<T> &vector) {
+    return tmemory{.count = vector.size(),
+                   .size = vector.size() * sizeof(T),
+                   .capacity = vector.capacity() * sizeof(T)};
+  };
+  // The capacity of the buffer inside the string.
+  static const std::size_t short_capacity = std::pmr::string{}.capacity();
+  auto string = [](const std::pmr::string &string) {
+    return tmemory{.count = 1,
+                   .size = string.size(),
+                   .capacity = string.capacity() > short_capacity
+                                   ? string.capacity() + 1
+                                   : 0};
+  };
+
+  tmemory_usage result;
+  result.records += vector(state.labels);
+  result.records += vector(state.projects);
+  result.records += vector(state.groups);
+  result.records += vector(state.tasks);
+  result.archive += vector(state.archived);
+  result.archive += vector(state.archive);
+
+  for (const auto &label : state.labels) {
+    result.strings += string(label.name);
+    result.strings += string(label.description);
+  }
+  for (const auto &project : state.projects) {
+    result.strings += string(project.name);
+    result.strings += string(project.description);
+  }
+  for (const auto &group : state.groups) {
+    result.strings += string(group.name);
+    result.strings += string(group.description);
+  }
+  for (const auto &tasks : {std::cref(state.tasks), std::cref(state.archive)})
+    for (const auto &task : tasks.get()) {
+      result.strings += string(task.title);
+      result.strings += string(task.description);
+      result.ids += vector(task.labels);
+      result.ids += vector(task.dependencies);
+      result.ids += vector(task.requirements);
+    }
+
+  return result;
+}
+
+} // namespace data
+
+/// *** VALIDATE ALL ***
+
+/** A record of the input, the text before the first header is a record too. */
+struct tsplit_record {
+  /** The text from the header up to the next header. */
+  std::string_view text;
+  int line;
+  bool header;
+  /** Whether an empty line ends the fields, else the next header does. */
+  bool terminated;
+};
+
+/**
+ * Splits @p input in records.
+ *
+ * This only looks at the start of the lines, the records themselves are
+ * parsed afterwards. A multiline value may contain headers, so it is skipped.
+ */
+std::vector<tsplit_record> split_records(std::string_view input) {
+  std::vector<tsplit_record> result;
+  result.push_back(tsplit_record{
+      .text = {}, .line = 1, .header = false, .terminated = true});
+
+  std::size_t begin = 0;
+  std::size_t pos = 0;
+  int line = 1;
+  auto next_line = [&] {
+    std::size_t end = std::min(input.find('\n', pos), input.size());
+    std::string_view text = input.substr(pos, end - pos);
+    pos = end + 1;
+    ++line;
+    return text;
+  };
+
+  while (pos < input.size()) {
+    std::size_t start = pos;
+    std::string_view text = next_line();
+    if (text.starts_with('[')) {
+      result.back().text = input.substr(begin, start - begin);
+      result.push_back(tsplit_record{
+          .text = {}, .line = line - 1, .header = true, .terminated = false});
+      begin = start;
+    } else if (text.empty()) {
+      result.back().terminated = true;
+    } else if (std::size_t separator = text.find('=', 1);
+               separator != std::string_view::npos &&
+               text.substr(separator + 1) == "<<<") {
+      while (pos < input.size() && next_line() != ">>>")
+        ;
+    }
+  }
+  result.back().text = input.substr(std::min(begin, input.size()));
+  return result;
+}
+
+/** The records parsed by one validation worker. */
+struct tvalidated {
+  data::tstate state{};
+  /** The line of each record in state, per kind of record. */
+  std::vector<int> label_lines{};
+  std::vector<int> project_lines{};
+  std::vector<int> group_lines{};
+  std::vector<int> task_lines{};
+  std::vector<data::tparse_error> errors{};
+};
+
+/**
+ * Parses @p record into @p result without validating its references.
+ *
+ * Like parse, a record reports its first error.
+ */
+void validate_record(const tsplit_record &record, tvalidated &result) {
+  parser parser(record.text, record.line, false);
+  if (record.header) {
+    std::size_t labels = result.state.labels.size();
+    std::size_t projects = result.state.projects.size();
+    std::size_t groups = result.state.groups.size();
+    std::size_t tasks = result.state.tasks.size();
+
+    // The split guarantees the record starts with its header.
+    std::string_view header = parser.parse()->data[0];
+    if (std::optional<data::tparse_error> error =
+            parse_header(result.state, parser, header)) {
+      result.errors.push_back(*std::move(error));
+      return;
+    }
+
+    if (result.state.labels.size() != labels)
+      result.label_lines.push_back(record.line);
+    if (result.state.projects.size() != projects)
+      result.project_lines.push_back(record.line);
+    if (result.state.groups.size() != groups)
+      result.group_lines.push_back(record.line);
+    if (result.state.tasks.size() != tasks)
+      result.task_lines.push_back(record.line);
+  }
+
+  while (true) {
+    std::expected<parser::tresult, data::tparse_error> line = parser.parse();
+    if (!line) {
+      result.errors.push_back(std::move(line).error());
+      return;
+    }
+
+    switch (line->type) {
+    case parser::tresult::eof:
+      return;
+
+    case parser::tresult::empty:
+    case parser::tresult::header:
+      break;
+
+    case parser::tresult::pair:
+      result.errors.push_back(data::tparse_error{
+          parser.line(),
+          std::string_view{line->data[0].begin(), line->data[1].end()},
+          "value is not attached to a header"});
+      return;
+    }
+  }
+}
+
+/** The line declaring each id, per kind of record. */
+struct tindexes {
+  std::unordered_map<std::size_t, int> labels{};
+  std::unordered_map<std::size_t, int> projects{};
+  std::unordered_map<std::size_t, int> groups{};
+  std::unordered_map<std::size_t, int> tasks{};
+};
+
+template <class Records>
+void index_records(const Records &records, std::span<const int> lines,
+                   std::unordered_map<std::size_t, int> &index,
+                   std::vector<data::tparse_error> &errors) {
+  for (std::size_t i = 0; i < records.size(); ++i)
+    if (!index.try_emplace(records[i].id, lines[i]).second)
+      errors.push_back(data::tparse_error{
+          lines[i], "",
+          std::format("id field »id« has multiple values »{}«",
+                      records[i].id)});
+}
+
+/**
+ * Validates the reference in @p field of the record at @p line.
+ *
+ * Like parse, the referenced record needs to be declared before the record.
+ */
+std::optional<data::tparse_error>
+validate_reference(const std::unordered_map<std::size_t, int> &index,
+                   std::size_t value, std::string_view field, int line) {
+  auto iter = index.find(value);
+  if (iter != index.end() && iter->second < line)
+    return {};
+
+  return data::tparse_error{
+      line, "",
+      std::format("id field »{}« has no linked record for value »{}«", field,
+                  value)};
+}
+
+std::optional<data::tparse_error>
+validate_task(const data::ttask &task, int line, const tindexes &indexes,
+              std::span<const std::size_t> archived) {
+  if (task.project)
+    if (auto error =
+            validate_reference(indexes.projects, task.project, "project", line))
+      return error;
+  if (task.group)
+    if (auto error =
+            validate_reference(indexes.groups, task.group, "group", line))
+      return error;
+  for (std::size_t label : task.labels)
+    if (auto error = validate_reference(indexes.labels, label, "labels", line))
+      return error;
+  for (std::size_t group : task.requirements) {
+    // A reference to another board can't be validated without that board.
+    if (group & data::board_reference)
+      continue;
+    if (auto error =
+            validate_reference(indexes.groups, group, "requirements", line))
+      return error;
+  }
+
+  if (std::ranges::binary_search(archived, task.id))
+    return data::tparse_error{
+        line, "",
+        std::format("task »{}« is both active and archived", task.id)};
+  return {};
+}
+
+/**
+ * Validates the references of the records in @p chunk.
+ *
+ * A record whose id is declared on another line is a duplicate, its error
+ * has already been reported.
+ */
+void validate_references(tvalidated &chunk, const tindexes &indexes,
+                         std::span<const std::size_t> archived) {
+  for (std::size_t i = 0; i < chunk.state.groups.size(); ++i) {
+    const data::tgroup &group = chunk.state.groups[i];
+    int line = chunk.group_lines[i];
+    if (indexes.groups.at(group.id) != line)
+      continue;
+    if (auto error = validate_reference(indexes.projects, group.project,
+                                        "project", line))
+      chunk.errors.push_back(*std::move(error));
+  }
+
+  for (std::size_t i = 0; i < chunk.state.tasks.size(); ++i) {
+    const data::ttask &task = chunk.state.tasks[i];
+    int line = chunk.task_lines[i];
+    if (indexes.tasks.at(task.id) != line)
+      continue;
+    if (auto error = validate_task(task, line, indexes, archived))
+      chunk.errors.push_back(*std::move(error));
+  }
+}
+
+/** Calls @p f with every index below @p count, each on its own thread. */
+template <class F> void run_parallel(std::size_t count, F f) {
+  std::vector<std::jthread> threads;
+  for (std::size_t i = 1; i < count; ++i)
+    threads.emplace_back(f, i);
+  f(std::size_t{0});
+}
+
+export namespace data {
+
+/**
+ * Validates the input data.
+ *
+ * Unlike parse this doesn't stop at the first error, every record reports
+ * its first error. The records are parsed in parallel, afterwards their
+ * references are checked against the ids of all records. A record with an
+ * error has no id, so the references to it are reported as well.
+ *
+ * Returns the errors sorted by line, no errors means parse succeeds.
+ */
+[[nodiscard]] std::vector<tparse_error> validate(std::string_view input) {
+  trace::tspan span{"data::validate"};
+
+  std::vector<tsplit_record> records = split_records(input);
+
+  // Small inputs aren't worth the threads.
+  constexpr std::size_t records_per_chunk = 1024;
+  std::size_t threads = std::max(1U, std::thread::hardware_concurrency());
+  std::size_t chunk_count =
+      std::clamp<std::size_t>(records.size() / records_per_chunk, 1, threads);
+  std::vector<tvalidated> chunks(chunk_count);
+
+  run_parallel(chunk_count, [&](std::size_t chunk) {
+    std::size_t first = records.size() * chunk / chunk_count;
+    std::size_t last = records.size() * (chunk + 1) / chunk_count;
+    for (std::size_t i = first; i < last; ++i) {
+      if (!records[i].header || records[i].terminated ||
+          i + 1 == records.size()) {
+        validate_record(records[i], chunks[chunk]);
+        continue;
+      }
+
+      // The record runs into the next header.
+      const tsplit_record &next = records[i + 1];
+      chunks[chunk].errors.push_back(
+          tparse_error{next.line, next.text.substr(0, next.text.find('\n')),
+                       "headers can't be nested"});
+    }
+  });
+
+  tindexes indexes;
+  std::vector<std::size_t> archived;
+  std::vector<tparse_error> result;
+  for (tvalidated &chunk : chunks) {
+    index_records(chunk.state.labels, chunk.label_lines, indexes.labels,
+                  result);
+    index_records(chunk.state.projects, chunk.project_lines, indexes.projects,
+                  result);
+    index_records(chunk.state.groups, chunk.group_lines, indexes.groups,
+                  result);
+    index_records(chunk.state.tasks, chunk.task_lines, indexes.tasks, result);
+    archived.insert(archived.end(), chunk.state.archived.begin(),
+                    chunk.state.archived.end());
+  }
+  std::ranges::sort(archived);
+
+  run_parallel(chunk_count, [&](std::size_t chunk) {
+    validate_references(chunks[chunk], indexes, archived);
+  });
+
+  for (tvalidated &chunk : chunks)
+    std::ranges::move(chunk.errors, std::back_inserter(result));
+  std::ranges::stable_sort(result, {}, &tparse_error::line_no);
+  return result;
+}
+
+} // namespace data
+
+template <class Out>
+void serialize_string(Out out, std::string_view name, std::string_view value) {
+  if (value.contains('\n') || value == "<<<")
+    std::format_to(out, "{}=<<<\n{}\n>>>\n", name, value);
+  else
+    std::format_to(out, "{}={}\n", name, value);
+}
+
+template <class Out>
+void serialize_id_list(Out out, std::string_view name,
+                       std::span<const std::size_t> ids) {
+  if (ids.empty())
+    return;
+
+  std::format_to(out, "{}=", name);
+  for (std::size_t i = 0; i < ids.size(); ++i)
+    std::format_to(out, "{}{}", i ? ", " : "", ids[i]);
+  std::format_to(out, "\n");
+}
+
+template <class Out>
+void serialize_common(Out out, std::string_view description,
+                      data::tcolor color) {
+  if (!description.empty())
+    serialize_string(out, "description", description);
+  if (color != data::tcolor::black)
+    std::format_to(out, "color={}\n",
+                   data::color_names[static_cast<std::size_t>(color)]);
+}
+
+template <class Out> void serialize_task(Out out, const data::ttask &task) {
+  std::format_to(out, "[task]\nid={}\n", task.id);
+  if (task.project)
+    std::format_to(out, "project={}\n", task.project);
+  if (task.group)
+    std::format_to(out, "group={}\n", task.group);
+  serialize_string(out, "title", task.title);
+  if (!task.description.empty())
+    serialize_string(out, "description", task.description);
+  if (task.status != data::ttask::tstatus::backlog)
+    std::format_to(out, "status={}\n",
+                   data::status_names[static_cast<std::size_t>(task.status)]);
+  if (task.after)
+    std::format_to(out, "after={}.{}.{}\n",
+                   static_cast<int>(task.after->year()),
+                   static_cast<unsigned>(task.after->month()),
+                   static_cast<unsigned>(task.after->day()));
+  serialize_id_list(out, "labels", task.labels);
+  serialize_id_list(out, "dependencies", task.dependencies);
+  serialize_id_list(out, "requirements", task.requirements);
+  std::format_to(out, "\n");
+}
+
+export namespace data {
+
+/**
+ * Returns the input of @p state.
+ *
+ * Parsing the result gives the same state. Optional fields with their
+ * default value are omitted. The result need not match the original input,
+ * the records are written grouped by kind: labels, projects, groups, and
+ * tasks.
+ */
+[[nodiscard]] std::string serialize(const tstate &state) {
+  trace::tspan span{"data::serialize"};
+
+  std::string result;
+  std::back_insert_iterator out{result};
+
+  for (const auto &label : state.labels) {
+    std::format_to(out, "[label]\nid={}\n", label.id);
+    serialize_string(out, "name", label.name);
+    serialize_common(out, label.description, label.color);
+    std::format_to(out, "\n");
+  }
+
+  for (const auto &project : state.projects) {
+    std::format_to(out, "[project]\nid={}\n", project.id);
+    serialize_string(out, "name", project.name);
+    serialize_common(out, project.description, project.color);
+    if (!project.active)
+      std::format_to(out, "active=false\n");
+    std::format_to(out, "\n");
+  }
+
+  for (const auto &group : state.groups) {
+    std::format_to(out, "[group]\nid={}\nproject={}\n", group.id,
+                   group.project);
+    serialize_string(out, "name", group.name);
+    serialize_common(out, group.description, group.color);
+    if (!group.active)
+      std::format_to(out, "active=false\n");
+    std::format_to(out, "\n");
+  }
+
+  if (!state.archived.empty()) {
+    std::format_to(out, "[archive]\n");
+    serialize_id_list(out, "ids", state.archived);
+    std::format_to(out, "\n");
+  }
+
+  for (const auto &task : state.tasks)
+    serialize_task(out, task);
+
+  return result;
+}
+
+/**
+ * Returns the archive of @p state.
+ *
+ * The archive should be loaded, parse_archive parses the result.
+ */
+[[nodiscard]] std::string serialize_archive(const tstate &state) {
+  trace::tspan span{"data::serialize_archive"};
+
+  std::string result;
+  std::back_insert_iterator out{result};
+  for (const auto &task : state.archive)
+    serialize_task(out, task);
+  return result;
+}
+
 } // namespace data
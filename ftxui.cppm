@@ -2,7 +2,21 @@ module;
 #include <ftxui/component/component.hpp>
 #include <ftxui/component/screen_interactive.hpp>
 #include <ftxui/dom/elements.hpp>
+#include <ftxui/dom/node.hpp>
 #include <ftxui/screen/screen.hpp>
+#include <ftxui/screen/string.hpp>
+#include <ftxui/screen/terminal.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <format>
+#include <iostream>
+#include <optional>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unistd.h>
 
 export module ftxui;
 
@@ -10,13 +24,16 @@ export namespace ftxui {
 
 using ftxui::bgcolor;
 using ftxui::border;
+using ftxui::Box;
 using ftxui::Button;
 using ftxui::Checkbox;
+using ftxui::CheckboxOption;
 using ftxui::Color;
 using ftxui::color;
 using ftxui::Component;
 using ftxui::ComponentBase;
 using ftxui::Components;
+using ftxui::Dimensions;
 using ftxui::Element;
 using ftxui::Elements;
 using ftxui::Event;
@@ -24,6 +41,11 @@ using ftxui::filler;
 using ftxui::hbox;
 using ftxui::hflow;
 using ftxui::Maybe;
+using ftxui::Menu;
+using ftxui::MenuOption;
+using ftxui::Mouse;
+using ftxui::reflect;
+using ftxui::Render;
 using ftxui::Renderer;
 using ftxui::Screen;
 using ftxui::ScreenInteractive;
@@ -34,24 +56,391 @@ using ftxui::vbox;
 using ftxui::window;
 using ftxui::xflex;
 using ftxui::yflex;
+using ftxui::yframe;
 using ftxui::operator|;
 
+namespace Terminal {
+using ftxui::Terminal::SetFallbackSize;
+using ftxui::Terminal::Size;
+} // namespace Terminal
+
 namespace Container {
 using ftxui::Container::Horizontal;
 using ftxui::Container::Tab;
 using ftxui::Container::Vertical;
 } // namespace Container
 
-ftxui::Element multiline_text(const std::string &the_text) {
-  ftxui::Elements output;
-  std::stringstream ss(the_text);
-  std::string line;
-  while (std::getline(ss, line)) {
-    output.push_back(ftxui::paragraph(line));
+/**
+ * A multiline text wrapped at word boundaries.
+ *
+ * The text is split in lines once, the lines are only wrapped again when the
+ * width changes. The text must outlive this object.
+ */
+class tmultiline_text {
+public:
+  explicit tmultiline_text(std::string_view text) {
+    while (!text.empty()) {
+      std::size_t end = text.find('\n');
+      lines_.push_back(text.substr(0, end));
+      text.remove_prefix(end == std::string_view::npos ? text.size() : end + 1);
+    }
+  }
+
+  /** Returns the text wrapped at @p width columns. */
+  Element render(int width) {
+    width = std::max(width, 1);
+    if (element_ && width == width_)
+      return element_;
+
+    width_ = width;
+    rows_.clear();
+    for (std::string_view line : lines_)
+      wrap(line);
+
+    Elements elements;
+    for (std::string_view row : rows_)
+      elements.push_back(text(std::string{row}));
+    element_ = vbox(std::move(elements));
+    return element_;
+  }
+
+  /** Returns the bytes allocated for the lines and rows. */
+  [[nodiscard]] std::size_t allocated() const {
+    return (lines_.capacity() + rows_.capacity()) * sizeof(std::string_view);
+  }
+
+  /** Returns whether the wrapped text is cached. */
+  [[nodiscard]] bool cached() const { return element_ != nullptr; }
+
+private:
+  /**
+   * Adds the rows of @p line to rows_.
+   *
+   * Like paragraph a word longer than the width gets a row of its own.
+   */
+  void wrap(std::string_view line) {
+    std::size_t first = std::string_view::npos;
+    std::size_t last = 0;
+    int used = 0;
+    std::size_t pos = line.find_first_not_of(' ');
+    while (pos != std::string_view::npos) {
+      std::size_t end = std::min(line.find(' ', pos), line.size());
+      int word = string_width(std::string{line.substr(pos, end - pos)});
+      if (first != std::string_view::npos) {
+        int gap = static_cast<int>(pos - last);
+        if (used + gap + word <= width_) {
+          used += gap + word;
+          last = end;
+          pos = line.find_first_not_of(' ', end);
+          continue;
+        }
+        rows_.push_back(line.substr(first, last - first));
+      }
+      first = pos;
+      last = end;
+      used = word;
+      pos = line.find_first_not_of(' ', end);
+    }
+    rows_.push_back(first == std::string_view::npos
+                        ? std::string_view{}
+                        : line.substr(first, last - first));
+  }
+
+  std::vector<std::string_view> lines_{};
+
+  /** The width used for rows_ and element_. */
+  int width_{0};
+  std::vector<std::string_view> rows_{};
+  Element element_{};
+};
+
+/**
+ * Computes the layout of an element once.
+ *
+ * FTXUI computes the layout of the document for every frame. When the same
+ * element is drawn again in the same box, the layout of the previous frame is
+ * still valid and is reused. The element is still drawn every frame, since
+ * the screen is cleared after writing a frame.
+ */
+class tcached_layout final : public Node {
+public:
+  explicit tcached_layout(Element child) : Node(Elements{std::move(child)}) {}
+
+  void ComputeRequirement() override {
+    if (!drawn_)
+      children_[0]->ComputeRequirement();
+    requirement_ = children_[0]->requirement();
   }
-  return ftxui::vbox(output);
+
+  void SetBox(Box box) override {
+    if (drawn_ && box.x_min == box_.x_min && box.x_max == box_.x_max &&
+        box.y_min == box_.y_min && box.y_max == box_.y_max)
+      return;
+
+    // The requirement does not depend on the box, only the positions change.
+    Node::SetBox(box);
+    children_[0]->SetBox(box);
+  }
+
+  void Render(Screen &screen) override {
+    children_[0]->Render(screen);
+    drawn_ = true;
+  }
+
+private:
+  /** Set after the first frame, the layout is complete then. */
+  bool drawn_{false};
+};
+
+/** Returns @p child, its layout is only computed for its first frame. */
+Element cache_layout(Element child) {
+  return std::make_shared<tcached_layout>(std::move(child));
 }
 
+/**
+ * Writes only the changed cells of the frames of a screen.
+ *
+ * FTXUI writes every frame completely to std::cout. This buffer replaces the
+ * buffer of std::cout; when a frame is flushed it compares the cells of the
+ * screen with the cells of the previous frame and writes the changed cells
+ * instead of the frame. Every flush is written with one write call and a
+ * frame is wrapped in the synchronized update mode of the terminal, so the
+ * terminal never shows a partially drawn frame.
+ *
+ * ScreenInteractive::Draw renders the screen and then inserts the frame with
+ * a single insertion, between the short cursor movements before and after
+ * it. A frame has at least one byte per cell, so the insertion of at least
+ * that many bytes is the frame; the output is not searched for it.
+ *
+ * The frame must start at the top left of the terminal, as it does for
+ * ScreenInteractive::Fullscreen. Hyperlinks are not supported.
+ */
+class tdamage_output final : public std::streambuf {
+public:
+  struct tstatistics {
+    std::size_t frames{0};
+    /** The number of bytes written by FTXUI. */
+    std::size_t input_bytes{0};
+    /** The number of bytes written to the terminal. */
+    std::size_t output_bytes{0};
+  };
+
+  explicit tdamage_output(Screen &screen)
+      : screen_(screen), previous_(std::cout.rdbuf(this)) {}
+
+  tdamage_output(const tdamage_output &) = delete;
+  tdamage_output &operator=(const tdamage_output &) = delete;
+
+  ~tdamage_output() override {
+    sync();
+    std::cout.rdbuf(previous_);
+  }
+
+  [[nodiscard]] const tstatistics &statistics() const { return statistics_; }
+
+protected:
+  int_type overflow(int_type c) override {
+    if (!traits_type::eq_int_type(c, traits_type::eof()))
+      buffer_.push_back(traits_type::to_char_type(c));
+    return traits_type::not_eof(c);
+  }
+
+  std::streamsize xsputn(const char *s, std::streamsize n) override {
+    auto size = static_cast<std::size_t>(n);
+    if (!frame_start_ && is_frame(size)) {
+      frame_start_ = buffer_.size();
+      frame_.assign(s, size);
+    } else
+      buffer_.append(s, size);
+    return n;
+  }
+
+  int sync() override {
+    if (buffer_.empty() && !frame_start_)
+      return 0;
+
+    std::string output = process();
+    statistics_.input_bytes += buffer_.size() + frame_.size();
+    statistics_.output_bytes += output.size();
+    buffer_.clear();
+    frame_.clear();
+    frame_start_.reset();
+    return write(output) ? 0 : -1;
+  }
+
+private:
+  /**
+   * Returns whether an insertion of @p size bytes is a frame of the screen.
+   *
+   * The cursor movements and the setup of the terminal are a few bytes, even
+   * clearing a resized terminal writes fewer bytes than it has cells.
+   */
+  bool is_frame(std::size_t size) const {
+    auto cells = static_cast<std::size_t>(screen_.dimx() * screen_.dimy());
+    return cells != 0 && size >= cells;
+  }
+
+  /** Returns the bytes to write for the buffered output. */
+  std::string process() {
+    // FTXUI writes a frame as the cursor movement to the top left of the
+    // frame, the frame, and the cursor movement to the cursor position. Any
+    // other output, like the setup of the terminal, is written as is.
+    if (!frame_start_) {
+      pixels_.clear();
+      return buffer_;
+    }
+
+    ++statistics_.frames;
+    std::string_view prefix{buffer_.data(), *frame_start_};
+    std::string_view suffix = std::string_view{buffer_}.substr(*frame_start_);
+
+    std::string cells;
+    // FTXUI only clears the terminal when it is resized, then all cells need
+    // to be written.
+    if (dimx_ != screen_.dimx() || dimy_ != screen_.dimy() || pixels_.empty())
+      cells = frame_;
+    else if (!write_changes(cells) && prefix == prefix_ && suffix == suffix_)
+      // Nothing changed and the cursor is already at its position. A
+      // different prefix, like a request of the cursor position, is written.
+      return {};
+
+    std::string result = "\x1B[?2026h";
+    result += prefix;
+    result += cells;
+    result += suffix;
+    result += "\x1B[?2026l";
+
+    prefix_ = prefix;
+    suffix_ = suffix;
+    store();
+    return result;
+  }
+
+  /**
+   * Writes the changed cells and moves the cursor to the bottom right, where
+   * writing the frame leaves the cursor.
+   *
+   * Returns whether a cell changed.
+   */
+  bool write_changes(std::string &output) const {
+    // Writing a few unchanged cells is cheaper than moving the cursor.
+    constexpr int gap = 4;
+
+    const Pixel *style = nullptr;
+    for (int y = 0; y < dimy_; ++y) {
+      for (int x = 0; x < dimx_; ++x) {
+        if (unchanged(x, y))
+          continue;
+
+        int first = x;
+        // The second half of a wide character, write the whole character.
+        if (first > 0 && screen_.PixelAt(first, y).character.empty())
+          --first;
+
+        int last = x;
+        for (int i = x + 1; i < dimx_ && i - last <= gap; ++i)
+          if (!unchanged(i, y))
+            last = i;
+
+        output += std::format("\x1B[{};{}H", y + 1, first + 1);
+        for (int i = first; i <= last; ++i) {
+          const Pixel &pixel = screen_.PixelAt(i, y);
+          if (!style || !same_style(*style, pixel)) {
+            write_style(output, pixel);
+            style = std::addressof(pixel);
+          }
+          output += pixel.character;
+        }
+        x = last;
+      }
+    }
+
+    if (style)
+      output += "\x1B[0m";
+    output += std::format("\x1B[{};{}H", dimy_, dimx_);
+    return style != nullptr;
+  }
+
+  bool unchanged(int x, int y) const {
+    const Pixel &lhs = pixels_[static_cast<std::size_t>(y * dimx_ + x)];
+    const Pixel &rhs = screen_.PixelAt(x, y);
+    return lhs.character == rhs.character && same_style(lhs, rhs);
+  }
+
+  static bool same_style(const Pixel &lhs, const Pixel &rhs) {
+    return lhs.blink == rhs.blink && lhs.bold == rhs.bold &&
+           lhs.dim == rhs.dim && lhs.inverted == rhs.inverted &&
+           lhs.underlined == rhs.underlined &&
+           lhs.underlined_double == rhs.underlined_double &&
+           lhs.strikethrough == rhs.strikethrough &&
+           lhs.background_color == rhs.background_color &&
+           lhs.foreground_color == rhs.foreground_color;
+  }
+
+  static void write_style(std::string &output, const Pixel &pixel) {
+    output += "\x1B[0m";
+    if (pixel.bold)
+      output += "\x1B[1m";
+    if (pixel.dim)
+      output += "\x1B[2m";
+    if (pixel.underlined)
+      output += "\x1B[4m";
+    if (pixel.blink)
+      output += "\x1B[5m";
+    if (pixel.inverted)
+      output += "\x1B[7m";
+    if (pixel.strikethrough)
+      output += "\x1B[9m";
+    if (pixel.underlined_double)
+      output += "\x1B[21m";
+    output += "\x1B[" + pixel.foreground_color.Print(false) + "m";
+    output += "\x1B[" + pixel.background_color.Print(true) + "m";
+  }
+
+  /** Stores the current frame to compare the next frame with. */
+  void store() {
+    dimx_ = screen_.dimx();
+    dimy_ = screen_.dimy();
+    pixels_.resize(static_cast<std::size_t>(dimx_ * dimy_));
+    for (int y = 0; y < dimy_; ++y)
+      for (int x = 0; x < dimx_; ++x)
+        pixels_[static_cast<std::size_t>(y * dimx_ + x)] =
+            screen_.PixelAt(x, y);
+  }
+
+  static bool write(std::string_view output) {
+    while (!output.empty()) {
+      ssize_t written = ::write(STDOUT_FILENO, output.data(), output.size());
+      if (written < 0) {
+        if (errno == EINTR)
+          continue;
+        return false;
+      }
+      output.remove_prefix(static_cast<std::size_t>(written));
+    }
+    return true;
+  }
+
+  Screen &screen_;
+  std::streambuf *previous_;
+  /** The output around the frame, the frame itself is kept in frame_. */
+  std::string buffer_{};
+  /** The frame inserted since the last flush. */
+  std::string frame_{};
+  /** The position of frame_ in buffer_, set when a frame was inserted. */
+  std::optional<std::size_t> frame_start_{};
+
+  /** The previous frame, empty when the terminal state is unknown. */
+  std::vector<Pixel> pixels_{};
+  /** The cursor movements before and after the previous frame. */
+  std::string prefix_{};
+  std::string suffix_{};
+  int dimx_{0};
+  int dimy_{0};
+
+  tstatistics statistics_{};
+};
+
 // position x y is the end of the visible area
 Decorator xfocusPosition(int x) { return focusPosition(x, 0); }
 Decorator yfocusPosition(int y) { return focusPosition(0, y); }
@@ -1,233 +1,500 @@
 export module gui:board;
-import :helpers;
+import :cache;
+import :column;
+import :statistics;
+import :timer;
+import :worker;
 import ftxui;
 import data;
 import std;
+import trace;
 
 export namespace detail {
 
-class tticket final : public ftxui::ComponentBase {
+/**
+ * Sends a status change to the owner of the board, set by the application.
+ *
+ * When a server owns the board the changes of the board go through it, the
+ * board only applies a change the server accepted.
+ */
+std::function<bool(std::size_t, data::ttask::tstatus)> status_sender;
+
+class tboard final : public ftxui::ComponentBase,
+                     private tcounted,
+                     private taccounted {
 public:
-  explicit tticket(const data::ttask *task) : task_(task) {
-
-    ftxui::Components result;
-    result.push_back(create_title(task_));
-    if (!task_->description.empty()) {
-      show_description = task_->status == data::ttask::tstatus::progress;
-      result.push_back(ftxui::Container::Horizontal(
-          {ftxui::Checkbox("", &show_description),
-           ftxui::Renderer([&] {
-             return ftxui::multiline_text(task_->description);
-           }) | ftxui::Maybe(&show_description)}));
-    }
+  tboard() {
+    subscribe();
+    load_tasks();
+  }
+
+  ftxui::Element Render() override {
+    trace::tspan span{"tboard::Render"};
 
-    if (!task_->dependencies.empty()) {
-      ftxui::Elements blockers;
-      for (auto id : task_->dependencies)
-        blockers.push_back(
-            ftxui::text(std::format("{:3} {}", id, data::get_task(id).title)));
+    if (!loaded())
+      return ftxui::text("Loading...");
+
+    if (!archive_added_ && (visible(data::tcolumn_index::done) ||
+                            visible(data::tcolumn_index::discarded) ||
+                            data::get_state().archive_loaded))
+      add_archive();
+
+    ftxui::Elements columns;
+    for (std::size_t i = 0; i < data::column_count; ++i)
+      if (column_visibility_[i]())
+        columns.emplace_back(render_column(i));
+
+    ftxui::Elements column_buttons;
+    for (const auto &button : column_buttons_)
+      column_buttons.emplace_back(button->Render());
+
+    // The columns fill the remaining height, they show the tickets fitting in
+    // their height.
+    ftxui::Element board = ftxui::vbox({
+        all_buttons_->Render(),
+        ftxui::hflow(std::move(column_buttons)),
+        ftxui::hbox(columns) | ftxui::yflex,
+    });
+    return board | ftxui::yflex;
+  }
 
-      result.push_back(ftxui::Renderer([=] {
-        return ftxui::window(ftxui::text("Dependencies"),
-                             ftxui::vbox(blockers));
-      }));
+  bool OnEvent(ftxui::Event event) override {
+    bool result = ComponentBase::OnEvent(event);
+
+    // The subscription reclassifies the tasks changed by undo and redo. A job
+    // reading the state blocks the changes, like the toggles of the
+    // configuration. The history is local, so it is disabled when a server
+    // owns the board.
+    if (!result && loaded() && !state_read() && !status_sender) {
+      if (event == ftxui::Event::Character('u'))
+        return data::undo();
+      if (event == ftxui::Event::Character('r'))
+        return data::redo();
     }
 
-    if (!task_->requirements.empty()) {
-      ftxui::Elements blockers;
-      for (auto id : task_->requirements)
-        blockers.push_back(
-            ftxui::text(std::format("{:3} {}", id, data::get_group(id).name)));
+    // The moves are applied after the event is handled, moving a task can
+    // destroy the ticket handling the event.
+    if (moves_.empty())
+      return result;
+
+    // A move can reopen an archived task, that moves the other tasks.
+    for (auto [id, direction] : moves_)
+      move(data::get_task(id), direction);
+    moves_.clear();
+    return true;
+  }
+
+  /** The columns account for themselves. */
+  void account(tmemory_usage &usage) const override {
+    account_component(usage, sizeof(*this));
+    usage.tasks += unordered_memory(expanded_);
+    usage.tasks += vector_memory(after_);
+    for (const auto &[content, window] : windows_)
+      usage.elements.count += window ? 1 : 0;
+  }
 
-      result.push_back(ftxui::Renderer([=] {
-        return ftxui::window(ftxui::text("Requirements"),
-                             ftxui::vbox(blockers));
-      }));
+private:
+  /**
+   * Returns the window of a column.
+   *
+   * The column caches its element, when it returns the element of the
+   * previous frame the window of the previous frame is reused.
+   */
+  ftxui::Element render_column(std::size_t index) {
+    auto &[content, window] = windows_[index];
+    if (columns_[index]->empty()) {
+      if (content || !window) {
+        content = nullptr;
+        window = ftxui::window(
+            ftxui::text(std::string(data::column_names[index])),
+            ftxui::filler() | ftxui::size(ftxui::WIDTH, ftxui::EQUAL, 20));
+      }
+      return window;
     }
 
-    if (task_->after) {
-      //  red when blocking?
-      result.push_back(ftxui::Renderer([&] {
-        return ftxui::window(
-            ftxui::text("After"),
-            ftxui::text(std::format("{:%Y.%m.%d}", *task_->after)));
-      }));
+    // Renders the column itself, the decorators of column_components_ would
+    // wrap the cached element in a new element every frame.
+    ftxui::Element element = columns_[index]->Render();
+    if (element != content || !window) {
+      content = element;
+      window = ftxui::window(
+          ftxui::text(std::string(data::column_names[index])),
+          element | ftxui::size(ftxui::WIDTH, ftxui::GREATER_THAN, 19) |
+              ftxui::size(ftxui::WIDTH, ftxui::LESS_THAN, 67));
     }
+    return window;
+  }
 
-    widget_ = ftxui::Container::Vertical(result) | ftxui::border;
+  [[nodiscard]] bool loaded() const { return dependents_.has_value(); }
+
+  /** Returns whether the column @p index is shown. */
+  [[nodiscard]] bool visible(data::tcolumn_index index) const {
+    return column_visibility_[std::to_underlying(index)]();
   }
 
-  ftxui::Element Render() override { return widget_->Render(); }
+  /** The result of classifying the tasks. */
+  struct tclassification {
+    std::array<std::vector<const data::ttask *>, data::column_count> tasks{};
+    std::optional<data::tdependents> dependents{};
+    /** The state_generation the tasks refer to. */
+    std::size_t generation{0};
+  };
 
-  bool OnEvent(ftxui::Event event) override { return widget_->OnEvent(event); }
+  /**
+   * Classifies the tasks on a worker thread.
+   *
+   * Determining whether a task is blocked is the expensive part of loading,
+   * so the UI stays responsive while loading a large board. The state is not
+   * changed while the job reads it, the changes made after the job is done
+   * are applied by create.
+   */
+  void load_tasks() {
+    worker().submit(
+        std::format("tboard::load_tasks/{}", static_cast<const void *>(this)),
+        [this, alive = std::weak_ptr{alive_},
+         reader = std::make_shared<tstate_reader>(),
+         generation = data::state_generation()](
+            std::stop_token stop) -> std::function<void()> {
+          trace::tspan span{"tboard::load_tasks"};
+
+          auto result = std::make_shared<tclassification>();
+          result->generation = generation;
+          for (const auto &task : data::get_state().tasks) {
+            if (stop.stop_requested())
+              return {};
+            result->tasks[std::to_underlying(data::get_column_index(task))]
+                .emplace_back(std::addressof(task));
+          }
+          result->dependents.emplace(data::get_state());
+
+          return [this, alive, result] {
+            // The board can be released before the job is done.
+            if (!alive.expired())
+              create(std::move(*result));
+          };
+        });
+  }
 
-  bool Focusable() const override { return true; }
+  void create(tclassification classification) {
+    trace::tspan span{"tboard::create"};
 
-private:
-  const data::ttask *task_;
-  bool show_description{false};
-  ftxui::Component widget_;
-};
+    // The columns only store the tasks, they create the tickets when the
+    // tasks become visible.
+    auto &tasks = classification.tasks;
+    dependents_ = std::move(classification.dependents);
+    generation_ = classification.generation;
 
-ftxui::Components
-create_tickets(const std::vector<const data::ttask *> &tasks) {
-  ftxui::Components result;
-  for (const auto *task : tasks)
-    result.emplace_back(std::make_shared<tticket>(task));
-
-  return result;
-}
-
-enum tcolumn_index {
-  inactive = 0,
-  blocked,
-  backlog,
-  selected,
-  progress,
-  review,
-  done,
-  discarded
-};
+    auto move = [this](const data::ttask *task, int direction) {
+      moves_.emplace_back(task->id, direction);
+    };
+    for (std::size_t i = 0; i < data::column_count; ++i) // zip view
+      columns_[i] =
+          std::make_shared<tcolumn>(std::move(tasks[i]), expanded_, move);
 
-inline constexpr std::size_t column_count = 8;
+    task_count_ = data::get_state().tasks.size();
+    Add(ftxui::Container::Vertical(
+        {create_column_buttons(), create_columns()}));
+    collect_after();
 
-inline constexpr std::array<std::string_view, column_count> column_names = {
-    "Inactive",    "Blocked",   "Backlog", "Selected",
-    "In progress", "In review", "Done",    "Discarded"};
+    // The changes made between classifying the tasks and now.
+    for (const auto &change : std::exchange(pending_, {}))
+      apply(change);
+    update_labels();
+  }
 
-tcolumn_index get_column_index(const data::ttask &task) {
-  switch (task.status) {
-  case data::ttask::tstatus::backlog:
-    if (!data::is_active(task))
-      return inactive;
+  /** Collects the tasks with an after date and schedules the first one. */
+  void collect_after() {
+    after_.clear();
+    for (const auto &task : data::get_state().tasks)
+      if (task.after)
+        after_.emplace_back(static_cast<std::chrono::sys_days>(*task.after),
+                            std::addressof(task));
+    std::ranges::sort(after_, std::greater{}, &tafter::first);
+    schedule_after();
+  }
 
-    if (data::is_blocked(task))
-      return blocked;
+  /**
+   * Keeps the columns up to date with the changes of the state.
+   *
+   * The board subscribes before loading its tasks, so the changes made while
+   * loading are not lost.
+   */
+  void subscribe() {
+    auto listener = [this](const data::tchange &change) {
+      if (!loaded()) {
+        pending_.push_back(change);
+        return;
+      }
+      apply(change);
+      update_labels();
+    };
+    subscriptions_.push_back(data::subscribe(
+        data::tentity::task, {}, data::tattribute::status, listener));
+    subscriptions_.push_back(data::subscribe(
+        data::tentity::project, {}, data::tattribute::active, listener));
+    subscriptions_.push_back(data::subscribe(
+        data::tentity::group, {}, data::tattribute::active, listener));
+  }
 
-    return backlog;
+  /**
+   * Applies @p change, the columns are rebuilt when the tasks have moved.
+   *
+   * The change is notified after the move, so the columns still refer to the
+   * old addresses.
+   */
+  void apply(const data::tchange &change) {
+    if (generation_ != data::state_generation())
+      rebuild();
+    else
+      changed(change);
+  }
 
-  case data::ttask::tstatus::selected:
-    return selected;
+  /**
+   * Classifies all tasks again.
+   *
+   * Reopening an archived task moves the tasks. This is rare, so unlike
+   * load_tasks the tasks are classified on the UI thread.
+   */
+  void rebuild() {
+    trace::tspan span{"tboard::rebuild"};
+
+    const data::tstate &state = data::get_state();
+    generation_ = data::state_generation();
+    dependents_.emplace(state);
+
+    std::array<std::vector<const data::ttask *>, data::column_count> tasks;
+    auto classify = [&](const auto &range) {
+      for (const auto &task : range)
+        tasks[std::to_underlying(data::get_column_index(task))].emplace_back(
+            std::addressof(task));
+    };
+    classify(state.tasks);
+    if (archive_added_)
+      classify(state.archive);
+    for (std::size_t i = 0; i < data::column_count; ++i) // zip view
+      columns_[i]->assign(std::move(tasks[i]));
+
+    task_count_ =
+        state.tasks.size() + (archive_added_ ? state.archive.size() : 0);
+    collect_after();
+  }
 
-  case data::ttask::tstatus::progress:
-    return progress;
+  /**
+   * Reclassifies the tasks affected by @p change.
+   *
+   * Only the changed tasks and the tasks depending on the changed record are
+   * reclassified.
+   */
+  void changed(const data::tchange &change) {
+    switch (change.entity) {
+    case data::tentity::task: {
+      const data::ttask &task = data::get_task(change.id);
+      reclassify(task);
+      reclassify(dependents_->affected_by(task));
+      break;
+    }
+    case data::tentity::project:
+      reclassify(dependents_->members_of(data::get_project(change.id)));
+      break;
+    case data::tentity::group:
+      reclassify(dependents_->members_of(data::get_group(change.id)));
+      break;
+    case data::tentity::label:
+      break;
+    }
+  }
+
+  /**
+   * Adds the archived tasks to their columns.
+   *
+   * The archive is only loaded when its columns are shown, or an archived
+   * task has been referenced. A failure leaves the archived tasks hidden.
+   */
+  void add_archive() {
+    trace::tspan span{"tboard::add_archive"};
+
+    archive_added_ = true;
+    if (!data::load_archive())
+      return;
+
+    const auto &archive = data::get_state().archive;
+    std::array<std::vector<const data::ttask *>, data::column_count> tasks;
+    for (const auto &task : archive)
+      tasks[std::to_underlying(data::get_column_index(task))].emplace_back(
+          std::addressof(task));
+    for (std::size_t i = 0; i < data::column_count; ++i) // zip view
+      if (!tasks[i].empty())
+        columns_[i]->insert(tasks[i]);
+
+    task_count_ += archive.size();
+    update_labels();
+  }
 
-  case data::ttask::tstatus::review:
-    return review;
+  /**
+   * Schedules reclassifying the tasks whose after date passes next.
+   *
+   * This keeps the board up to date without polling the clock.
+   */
+  void schedule_after() {
+    // The tasks are blocked until their after date has passed.
+    auto now = std::chrono::system_clock::now();
+    while (!after_.empty() && after_.back().first < now) {
+      reclassify(*after_.back().second);
+      after_.pop_back();
+    }
 
-  case data::ttask::tstatus::done:
-    return done;
+    if (after_.empty())
+      return;
 
-  case data::ttask::tstatus::discarded:
-    return discarded;
+    timer_.schedule(after_.back().first + std::chrono::seconds{1},
+                    [this, alive = std::weak_ptr{alive_}] {
+                      if (alive.expired())
+                        return;
+                      schedule_after();
+                      update_labels();
+                    });
   }
-}
 
-class tboard final : public ftxui::ComponentBase {
-public:
-  tboard() { load_tasks(); }
+  /**
+   * Moves @p task to the previous or next status.
+   *
+   * Only the task and the tasks that depend on it can change their column,
+   * the other columns are not touched.
+   */
+  void move(const data::ttask &task, int direction) {
+    trace::tspan span{"tboard::move"};
+
+    auto status = static_cast<int>(task.status) + direction;
+    if (status < 0 || status >= static_cast<int>(data::status_names.size()))
+      return;
+
+    auto target = static_cast<data::ttask::tstatus>(status);
+    if (status_sender && !status_sender(task.id, target))
+      return;
+
+    // The subscription reclassifies the task and its dependents.
+    data::set_status(task.id, target);
+  }
 
-  ftxui::Element Render() override {
+  /** Moves @p task to its column, when it is not in that column. */
+  void reclassify(const data::ttask &task) {
+    const auto &column =
+        columns_[std::to_underlying(data::get_column_index(task))];
+    if (column->contains(std::addressof(task)))
+      return;
+
+    for (const auto &other : columns_)
+      if (other->erase(std::addressof(task)))
+        break;
+    column->insert(std::addressof(task));
+  }
 
-    // Note this function "digs up" the elements from the internal container.
-    // This gives a lot of hard-coded magic numbers. This should be improved.
+  /** Moves the tasks @p ids to their columns. */
+  void reclassify(std::span<const std::size_t> ids) {
+    for (auto id : ids)
+      reclassify(data::get_task(id));
+  }
 
-    ftxui::Elements columns;
-    for (std::size_t i = 0; i < column_count; ++i)
-      if (column_visibility_[i]())
-        columns.emplace_back(ftxui::window(
-            ftxui::text(std::string(column_names[i])),
-            ChildAt(0)->ChildAt(1)
-                        ->ChildAt(i)
-                        ->ChildAt(0) // maybe
-                        ->ChildAt(0) // maximum width
-                        ->ChildAt(0) // minimum width
-                        ->ChildCount() == 0
-                ? ftxui::filler() | ftxui::size(ftxui::WIDTH, ftxui::EQUAL, 20)
-                : ChildAt(0)->ChildAt(1)->ChildAt(i)->Render()));
-
-    return ftxui::vbox({
-        ChildAt(0)->ChildAt(0)->ChildAt(0)->Render(),
-        ftxui::hflow({
-            ChildAt(0)->ChildAt(0)->ChildAt(1)->ChildAt(0)->Render(),
-            ChildAt(0)->ChildAt(0)->ChildAt(1)->ChildAt(1)->Render(),
-            ChildAt(0)->ChildAt(0)->ChildAt(1)->ChildAt(2)->Render(),
-            ChildAt(0)->ChildAt(0)->ChildAt(1)->ChildAt(3)->Render(),
-            ChildAt(0)->ChildAt(0)->ChildAt(1)->ChildAt(4)->Render(),
-            ChildAt(0)->ChildAt(0)->ChildAt(1)->ChildAt(5)->Render(),
-            ChildAt(0)->ChildAt(0)->ChildAt(1)->ChildAt(6)->Render(),
-            ChildAt(0)->ChildAt(0)->ChildAt(1)->ChildAt(7)->Render(),
-        }),
-        ftxui::hbox(columns),
-    });
+  /** Updates the task counts of the checkboxes. */
+  void update_labels() {
+    for (std::size_t i = 0; i < data::column_count; ++i) // zip view
+      column_labels_[i] = std::format("{} ({}/{})", data::column_names[i],
+                                      columns_[i]->size(), task_count_);
+
+    auto refinement = std::span{columns_}.first(
+        std::to_underlying(data::tcolumn_index::progress));
+    std::size_t refinement_count = std::accumulate(
+        refinement.begin(), refinement.end(), std::size_t{0},
+        [](std::size_t init, const auto &column) {
+          return init + column->size();
+        });
+
+    all_label_ = std::format("All ({}/{})", task_count_, task_count_);
+    refinement_label_ =
+        std::format("Refinement ({}/{})", refinement_count, task_count_);
   }
 
-private:
-  void load_tasks() {
-    std::array<std::vector<ftxui::Component>, column_count> columns;
-    // Creates a ticket for every task and stores the shared pointer in two
-    // places:
-    // - tickets_ as a ticket
-    // - columns as a component, this will be used further in this function.
-    for (const auto &task : data::get_state().tasks)
-      columns[get_column_index(task)].emplace_back(tickets_.emplace_back(
-          std::make_shared<tticket>(std::addressof(task))));
+  ftxui::Component create_column_buttons() {
+    update_labels();
 
-    Add(ftxui::Container::Vertical(
-        {create_column_buttons(columns), create_columns(columns)}));
-  }
-
-  ftxui::Component create_column_buttons(
-      const std::array<ftxui::Components, column_count> &columns) {
-
-    ftxui::Components column_buttons;
-    for (std::size_t i = 0; i < column_count; ++i) // zip view
-      column_buttons.emplace_back(
-          ftxui::Checkbox(std::format("{} ({}/{}))", column_names[i],
-                                      columns[i].size(), tickets_.size()),
-                          std::addressof(visible_[i])));
-
-    return ftxui::Container::Vertical({
-        ftxui::Container::Horizontal({
-            ftxui::Checkbox(
-                std::format("All ({}/{})", tickets_.size(), tickets_.size()),
-                std::addressof(all_visible_)),
-            ftxui::Checkbox(
-                std::format("Refinement ({}/{})",
-                            std::accumulate(
-                                columns.begin(), columns.begin() + progress, 0,
-                                [](std::size_t init, const auto &column) {
-                                  return init + column.size();
-                                }),
-                            tickets_.size()),
-                std::addressof(refinement_visible_))   //
-        }),                                            //
-        ftxui::Container::Horizontal({column_buttons}) //
-    });                                                //
-  }
-
-  ftxui::Component
-  create_columns(std::array<ftxui::Components, column_count> tickets) {
-    ftxui::Components columns;
-    for (std::size_t i = 0; i < column_count; ++i) // zip view
-      columns.emplace_back(
-          ftxui::Container::Vertical({std::move(tickets[i])})  //
+    // The checkboxes refer to the labels, so update_labels updates them.
+    for (std::size_t i = 0; i < data::column_count; ++i) // zip view
+      column_buttons_[i] = ftxui::Checkbox(std::addressof(column_labels_[i]),
+                                           std::addressof(visible_[i]));
+
+    all_buttons_ = ftxui::Container::Horizontal({
+        ftxui::Checkbox(std::addressof(all_label_),
+                        std::addressof(all_visible_)),
+        ftxui::Checkbox(std::addressof(refinement_label_),
+                        std::addressof(refinement_visible_)) //
+    });
+
+    return ftxui::Container::Vertical(
+        {all_buttons_, ftxui::Container::Horizontal(ftxui::Components(
+                           column_buttons_.begin(), column_buttons_.end()))});
+  }
+
+  ftxui::Component create_columns() {
+    for (std::size_t i = 0; i < data::column_count; ++i) // zip view
+      column_components_[i] =
+          columns_[i]                                          //
           | ftxui::size(ftxui::WIDTH, ftxui::GREATER_THAN, 19) //
           | ftxui::size(ftxui::WIDTH, ftxui::LESS_THAN, 67)    //
-          | ftxui::Maybe(column_visibility_[i])                //
-      );
+          | ftxui::Maybe(column_visibility_[i]);               //
 
-    return ftxui::Container::Horizontal({columns});
+    return ftxui::Container::Horizontal(ftxui::Components(
+        column_components_.begin(), column_components_.end()));
   }
 
-  std::vector<std::shared_ptr<tticket>> tickets_;
+  std::size_t task_count_{0};
+  /** Whether the archived tasks have been added to the columns. */
+  bool archive_added_{false};
+  /** The tasks with an after date, the earliest date last. */
+  using tafter = std::pair<std::chrono::sys_days, const data::ttask *>;
+  std::vector<tafter> after_{};
+  ttimer timer_{};
+
+  /** Set when the tasks are loaded. */
+  std::optional<data::tdependents> dependents_{};
+  /** The state_generation the pointers to the tasks refer to. */
+  std::size_t generation_{0};
+  /** Tells the jobs whether the board still exists. */
+  std::shared_ptr<bool> alive_{std::make_shared<bool>()};
+  /** The changes of the state made before the tasks are loaded. */
+  std::vector<data::tchange> pending_{};
+  /** The moves requested while handling the current event, by task id. */
+  std::vector<std::pair<std::size_t, int>> moves_{};
+  /** Whether the description of a task, identified by its id, is shown. */
+  std::unordered_map<std::size_t, bool> expanded_{};
+
+  std::array<std::shared_ptr<tcolumn>, data::column_count> columns_{};
+  /** The columns with their layout, as used in the container. */
+  std::array<ftxui::Component, data::column_count> column_components_{};
+  /** The element of each column and its window in the last frame. */
+  std::array<std::pair<ftxui::Element, ftxui::Element>, data::column_count>
+      windows_{};
+
+  ftxui::Component all_buttons_{};
+  std::array<ftxui::Component, data::column_count> column_buttons_{};
+  std::string all_label_{};
+  std::string refinement_label_{};
+  std::array<std::string, data::column_count> column_labels_{};
 
   bool all_visible_{false};
   bool refinement_visible_{false};
-  std::array<bool, column_count> visible_{false, false, true,  true,
-                                          true,  true,  false, false};
+  /** Whether a column is shown, by default the columns with open tasks. */
+  std::array<bool, data::column_count> visible_{
+      false, // inactive
+      false, // blocked
+      true,  // backlog
+      true,  // selected
+      true,  // progress
+      true,  // review
+      false, // done
+      false, // discarded
+  };
 
-  std::array<std::function<bool()>, column_count> column_visibility_{
+  std::array<std::function<bool()>, data::column_count> column_visibility_{
       [&] { return all_visible_ | refinement_visible_ | visible_[0]; },
       [&] { return all_visible_ | refinement_visible_ | visible_[1]; },
       [&] { return all_visible_ | refinement_visible_ | visible_[2]; },
@@ -237,6 +504,9 @@ private:
       [&] { return all_visible_ | visible_[6]; },
       [&] { return all_visible_ | visible_[7]; },
   };
+
+  /** Declared last, so the listeners are removed before the other members. */
+  std::vector<data::tsubscription> subscriptions_{};
 };
 
 } // namespace detail
@@ -0,0 +1,151 @@
+export module gui:cache;
+import :statistics;
+import data;
+import ftxui;
+import std;
+
+export namespace detail {
+
+using tkind = data::tentity;
+
+/**
+ * Tracks the changes of the records.
+ *
+ * Every change gets a new, higher, revision number. A cache stores the
+ * highest revision of the records it depends on and is rebuilt when that
+ * revision changes. The changes made through data are tracked
+ * automatically.
+ *
+ * A change of a project also touches its groups, the ticket of a task in a
+ * group shows the project of the group. So a ticket only needs the revision
+ * of its group, without looking up the group.
+ */
+class trevisions {
+public:
+  trevisions() {
+    for (std::size_t i = 0; i < subscriptions_.size(); ++i)
+      subscriptions_[i] = data::subscribe(
+          static_cast<tkind>(i), {}, data::tattribute::any,
+          [this](const data::tchange &change) {
+            touch(change.entity, change.id);
+          });
+  }
+  // The subscriptions refer to this object.
+  trevisions(const trevisions &) = delete;
+  trevisions &operator=(const trevisions &) = delete;
+
+  /** Adds the memory of the revisions to @p usage. */
+  void account(tmemory_usage &usage) const {
+    for (const auto &revisions : revisions_)
+      usage.revisions += unordered_memory(revisions);
+  }
+
+  [[nodiscard]] std::size_t get(tkind kind, std::size_t id) const {
+    const auto &revisions = revisions_[static_cast<std::size_t>(kind)];
+    auto iter = revisions.find(id);
+    return iter == revisions.end() ? 0 : iter->second;
+  }
+
+  /** Marks the record as changed, a project marks its groups too. */
+  void touch(tkind kind, std::size_t id) {
+    revisions_[static_cast<std::size_t>(kind)][id] = ++revision_;
+    if (kind != tkind::project)
+      return;
+
+    for (const auto &group : data::get_state().groups)
+      if (group.project == id)
+        touch(tkind::group, group.id);
+  }
+
+private:
+  std::size_t revision_{0};
+  std::array<std::unordered_map<std::size_t, std::size_t>, 4> revisions_{};
+  std::array<data::tsubscription, 4> subscriptions_{};
+};
+
+trevisions revisions;
+
+/**
+ * Returns the highest revision of the task and the records shown on its
+ * ticket.
+ */
+[[nodiscard]] std::size_t stamp(const data::ttask &task) {
+  std::size_t result = revisions.get(tkind::task, task.id);
+  auto update = [&](tkind kind, std::size_t id) {
+    result = std::max(result, revisions.get(kind, id));
+  };
+
+  if (task.project)
+    update(tkind::project, task.project);
+  // The revision of a group includes its project.
+  if (task.group)
+    update(tkind::group, task.group);
+  for (auto id : task.labels)
+    update(tkind::label, id);
+  for (auto id : task.dependencies)
+    update(tkind::task, id);
+  for (auto id : task.requirements)
+    update(tkind::group, id);
+
+  return result;
+}
+
+/** The cached layout of a description. */
+struct tdescription {
+  std::size_t revision;
+  ftxui::tmultiline_text text;
+};
+
+/**
+ * The layout of the descriptions, by task id.
+ *
+ * The layout survives destroying the ticket, so scrolling back to a ticket
+ * does not split the description again. The layouts refer to the text of the
+ * descriptions, so they are dropped when the state is replaced.
+ */
+std::unordered_map<std::size_t, tdescription> descriptions;
+/** The generation of the state the descriptions refer to. */
+std::size_t descriptions_generation{0};
+
+/** Returns the description of @p task wrapped at @p width columns. */
+ftxui::Element description(const data::ttask &task, int width) {
+  if (descriptions_generation != data::state_generation()) {
+    descriptions.clear();
+    descriptions_generation = data::state_generation();
+  }
+
+  std::size_t revision = revisions.get(tkind::task, task.id);
+  auto iter = descriptions.find(task.id);
+  if (iter == descriptions.end() || iter->second.revision != revision)
+    iter = descriptions
+               .insert_or_assign(
+                   task.id,
+                   tdescription{revision,
+                                ftxui::tmultiline_text{task.description}})
+               .first;
+
+  return iter->second.text.render(width);
+}
+
+/**
+ * Returns the memory of the GUI.
+ *
+ * This visits the components reporting their memory, so it is meant for
+ * diagnostics, not for every frame.
+ */
+tmemory_usage memory_usage() {
+  tmemory_usage result;
+  for (const taccounted *component : accounted)
+    component->account(result);
+  result.components.count = statistics.components;
+
+  revisions.account(result);
+  result.descriptions += unordered_memory(descriptions);
+  for (const auto &[id, description] : descriptions) {
+    result.descriptions.capacity += description.text.allocated();
+    result.elements.count += description.text.cached();
+  }
+  return result;
+}
+
+} // namespace detail
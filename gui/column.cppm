@@ -0,0 +1,406 @@
+export module gui:column;
+import :cache;
+import :statistics;
+import :ticket;
+import ftxui;
+import data;
+import std;
+
+export namespace detail {
+
+/**
+ * A column of tickets.
+ *
+ * The column only stores the tasks, the tickets are only created for the
+ * tasks in the visible part of the column. So the cost of a column depends on
+ * the size of the screen, not on the number of tasks.
+ *
+ * The column scrolls to keep the selected task visible.
+ *
+ * The element of the column is cached, it is only rebuilt when the visible
+ * tasks, the selection, the focus, or the size of the column changes.
+ */
+class tcolumn final : public ftxui::ComponentBase,
+                      private tcounted,
+                      private taccounted {
+public:
+  /** Requests to move a task to the previous, -1, or next, 1, status. */
+  using tmove = std::function<void(const data::ttask *, int)>;
+
+  /**
+   * @param tasks The tasks, in the order of the state, see data::rank.
+   * @param expanded Whether the description of a task, identified by its id,
+   * is shown. This state is shared by all columns of the board.
+   */
+  tcolumn(std::vector<const data::ttask *> tasks,
+          std::unordered_map<std::size_t, bool> &expanded, tmove move)
+      : tasks_(std::move(tasks)), expanded_(std::addressof(expanded)),
+        move_(std::move(move)) {}
+
+  [[nodiscard]] bool empty() const { return tasks_.empty(); }
+  [[nodiscard]] std::size_t size() const { return tasks_.size(); }
+
+  [[nodiscard]] bool contains(const data::ttask *task) const {
+    return std::ranges::binary_search(tasks_, rank(task), std::less{},
+                                      &tcolumn::rank);
+  }
+
+  /** Adds @p task, the selection stays on the selected task. */
+  void insert(const data::ttask *task) {
+    auto iter = lower_bound(task);
+    auto index = static_cast<std::size_t>(iter - tasks_.begin());
+    tasks_.insert(iter, task);
+    if (tasks_.size() > 1 && index <= selected_)
+      ++selected_;
+    if (tasks_.size() > 1 && index < first_)
+      ++first_;
+    dirty_ = true;
+  }
+
+  /** Adds @p tasks, the selection stays on the selected task. */
+  void insert(std::span<const data::ttask *const> tasks) {
+    const data::ttask *selected = empty() ? nullptr : tasks_[selected_];
+    const data::ttask *first = empty() ? nullptr : tasks_[first_];
+    tasks_.insert(tasks_.end(), tasks.begin(), tasks.end());
+    std::ranges::sort(tasks_, std::less{}, &tcolumn::rank);
+    auto index_of = [&](const data::ttask *task) {
+      return static_cast<std::size_t>(lower_bound(task) - tasks_.begin());
+    };
+    selected_ = selected ? index_of(selected) : 0;
+    first_ = first ? index_of(first) : 0;
+    dirty_ = true;
+  }
+
+  /**
+   * Replaces the tasks, after the tasks of the state have moved.
+   *
+   * The old pointers are not dereferenced, so the selection keeps its index.
+   */
+  void assign(std::vector<const data::ttask *> tasks) {
+    tasks_ = std::move(tasks);
+    selected_ = std::min(selected_, tasks_.empty() ? 0 : tasks_.size() - 1);
+    first_ = std::min(first_, selected_);
+    last_ = first_;
+    tickets_.clear();
+    rendered_.clear();
+    DetachAllChildren();
+    element_ = nullptr;
+    dirty_ = true;
+  }
+
+  /**
+   * Removes @p task, returns whether the column contained the task.
+   *
+   * When the task is selected the next task is selected.
+   */
+  bool erase(const data::ttask *task) {
+    auto iter = lower_bound(task);
+    if (iter == tasks_.end() || *iter != task)
+      return false;
+
+    auto index = static_cast<std::size_t>(iter - tasks_.begin());
+    tasks_.erase(iter);
+    tickets_.erase(task->id);
+    if (index < selected_)
+      --selected_;
+    if (index < first_)
+      --first_;
+    if (tasks_.empty())
+      DetachAllChildren();
+    dirty_ = true;
+    return true;
+  }
+
+  ftxui::Element Render() override {
+    if (tasks_.empty())
+      return ftxui::vbox({}) | ftxui::reflect(box_);
+
+    selected_ = std::min(selected_, tasks_.size() - 1);
+    first_ = std::min(first_, selected_);
+
+    int height = available_height();
+    tkey key{.first = first_,
+             .selected = selected_,
+             .stamp = stamp(),
+             .height = height,
+             .width = box_.x_max - box_.x_min,
+             .focused = Focused()};
+    if (element_ && !dirty_ && key == key_) {
+      statistics.visible_tickets += last_ - first_ + 1;
+      return element_;
+    }
+
+    std::size_t last = fill(height);
+    if (selected_ > last ||
+        (selected_ == last && height_of(first_, last) > height)) {
+      // Scroll down until the selected ticket is the last visible ticket.
+      first_ = selected_;
+      while (first_ > 0 && height_of(first_ - 1, selected_) <= height)
+        --first_;
+      last = fill(height);
+    }
+
+    materialize(last);
+
+    ftxui::Elements elements;
+    for (std::size_t i = first_; i <= last; ++i)
+      elements.push_back(render(i));
+
+    rendered_.clear();
+    statistics.visible_tickets += last - first_ + 1;
+    // The column fills the height of the board, the frame clips the last
+    // ticket. So the box of the column is the height available next frame.
+    element_ = ftxui::vbox(std::move(elements)) | ftxui::yframe |
+               ftxui::yflex | ftxui::reflect(box_);
+    // The selection may have scrolled the column.
+    key.first = first_;
+    key.stamp = stamp();
+    key_ = key;
+    dirty_ = false;
+    return element_;
+  }
+
+  bool OnEvent(ftxui::Event event) override {
+    bool result = handle(std::move(event));
+    dirty_ = dirty_ || result;
+    return result;
+  }
+
+  bool Focusable() const override { return !tasks_.empty(); }
+
+  ftxui::Component ActiveChild() override {
+    if (tasks_.empty())
+      return nullptr;
+
+    auto iter = tickets_.find(tasks_[selected_]->id);
+    return iter == tickets_.end() ? nullptr : iter->second;
+  }
+
+  void SetActiveChild(ftxui::ComponentBase *child) override {
+    for (std::size_t i = first_; i < tasks_.size(); ++i) {
+      auto iter = tickets_.find(tasks_[i]->id);
+      if (iter == tickets_.end())
+        break;
+
+      if (iter->second.get() == child) {
+        dirty_ = dirty_ || selected_ != i;
+        selected_ = i;
+        return;
+      }
+    }
+  }
+
+  /** Forces the next Render to rebuild the column and its tickets. */
+  void invalidate() {
+    dirty_ = true;
+    for (const auto &ticket : tickets_)
+      ticket.second->invalidate();
+  }
+
+  /** Includes the materialized tickets. */
+  void account(tmemory_usage &usage) const override {
+    account_component(usage, sizeof(*this));
+    usage.tasks += vector_memory(tasks_);
+    usage.tasks += unordered_memory(tickets_);
+    for (const auto &ticket : tickets_)
+      ticket.second->account(usage);
+    usage.elements.count += element_ ? 1 : 0;
+  }
+
+private:
+  /** The state the cached element depends on. */
+  struct tkey {
+    std::size_t first{0};
+    std::size_t selected{0};
+    std::size_t stamp{0};
+    int height{0};
+    int width{0};
+    bool focused{false};
+
+    bool operator==(const tkey &) const = default;
+  };
+
+  /**
+   * The position of @p task in the state, this orders the tasks.
+   *
+   * The addresses of the tasks and the archive are unrelated, so the tasks
+   * are not ordered by their address.
+   */
+  static std::size_t rank(const data::ttask *task) { return data::rank(*task); }
+
+  auto lower_bound(const data::ttask *task) {
+    return std::ranges::lower_bound(tasks_, rank(task), std::less{},
+                                    &tcolumn::rank);
+  }
+
+  /** Returns the highest revision of the visible tasks. */
+  std::size_t stamp() const {
+    std::size_t result = 0;
+    for (std::size_t i = first_; i <= std::min(last_, tasks_.size() - 1); ++i)
+      result = std::max(result, detail::stamp(*tasks_[i]));
+    return result;
+  }
+
+  bool handle(ftxui::Event event) {
+    if (event.is_mouse()) {
+      if (!box_.Contain(event.mouse().x, event.mouse().y))
+        return false;
+
+      if (event.mouse().button == ftxui::Mouse::WheelUp)
+        return select(selected_ == 0 ? selected_ : selected_ - 1);
+      if (event.mouse().button == ftxui::Mouse::WheelDown)
+        return select(selected_ + 1);
+
+      // The hover state of the tickets can change without the event being
+      // handled.
+      dirty_ = true;
+      return ComponentBase::OnEvent(std::move(event));
+    }
+
+    if (ftxui::Component child = ActiveChild(); child && child->OnEvent(event))
+      return true;
+
+    if (event == ftxui::Event::ArrowUp || event == ftxui::Event::Character('k'))
+      return selected_ != 0 && select(selected_ - 1);
+    if (event == ftxui::Event::ArrowDown ||
+        event == ftxui::Event::Character('j'))
+      return select(selected_ + 1);
+    if (event == ftxui::Event::PageUp)
+      return selected_ != 0 &&
+             select(selected_ - std::min(selected_, page_size()));
+    if (event == ftxui::Event::PageDown)
+      return select(
+          std::min(selected_ + page_size(), tasks_.size() - 1));
+    if (event == ftxui::Event::Home)
+      return selected_ != 0 && select(0);
+    if (event == ftxui::Event::End)
+      return select(tasks_.size() - 1);
+
+    return false;
+  }
+
+  /** Returns whether @p index is a valid index and makes it the selection. */
+  bool select(std::size_t index) {
+    if (index >= tasks_.size() || index == selected_)
+      return false;
+
+    selected_ = index;
+    return true;
+  }
+
+  std::size_t page_size() const {
+    return std::max(std::size_t{1}, last_ - first_);
+  }
+
+  /**
+   * The number of lines available for the tickets.
+   *
+   * This is the height of the column in the layout of the last frame. Before
+   * the first frame the column is assumed to reach the bottom of the
+   * terminal.
+   */
+  int available_height() const {
+    if (box_.y_max <= box_.y_min)
+      return std::max(1, ftxui::Terminal::Size().dimy - box_.y_min);
+    return box_.y_max - box_.y_min + 1;
+  }
+
+  /**
+   * Returns the index of the last ticket that is visible when @p first_ is
+   * the first visible ticket.
+   */
+  std::size_t fill(int height) {
+    int used = 0;
+    std::size_t result = first_;
+    for (; result < tasks_.size(); ++result) {
+      used += height_of(result);
+      if (used >= height)
+        break;
+    }
+    last_ = std::min(result, tasks_.size() - 1);
+    return last_;
+  }
+
+  int height_of(std::size_t index) {
+    ftxui::Element &element = render(index);
+    element->ComputeRequirement();
+    return element->requirement().min_y;
+  }
+
+  int height_of(std::size_t first, std::size_t last) {
+    int result = 0;
+    for (std::size_t i = first; i <= last; ++i)
+      result += height_of(i);
+    return result;
+  }
+
+  /** Returns the element of a ticket, rendered at most once per frame. */
+  ftxui::Element &render(std::size_t index) {
+    auto [iter, inserted] = rendered_.try_emplace(index);
+    if (inserted)
+      iter->second = ticket(index)->Render();
+
+    return iter->second;
+  }
+
+  std::shared_ptr<tticket> ticket(std::size_t index) {
+    const data::ttask *task = tasks_[index];
+    auto [iter, inserted] = tickets_.try_emplace(task->id);
+    if (inserted) {
+      bool &expanded =
+          expanded_
+              ->try_emplace(task->id,
+                            task->status == data::ttask::tstatus::progress)
+              .first->second;
+      iter->second = std::make_shared<tticket>(
+          task, expanded,
+          [this, task](int direction) { move_(task, direction); });
+      // Attach the ticket before it is rendered, else it renders as focused.
+      Add(iter->second);
+    }
+
+    return iter->second;
+  }
+
+  /**
+   * Makes the visible tickets the children of the column.
+   *
+   * The tickets that are no longer visible are destroyed, the tickets that
+   * are still visible are reused.
+   */
+  void materialize(std::size_t last) {
+    std::span visible{tasks_.begin() + static_cast<std::ptrdiff_t>(first_),
+                      last - first_ + 1};
+    std::erase_if(tickets_, [&](const auto &element) {
+      return std::ranges::find(visible, element.first, &data::ttask::id) ==
+             visible.end();
+    });
+
+    DetachAllChildren();
+    for (std::size_t i = first_; i <= last; ++i)
+      Add(ticket(i));
+  }
+
+  std::vector<const data::ttask *> tasks_;
+  std::unordered_map<std::size_t, bool> *expanded_;
+  tmove move_;
+
+  /** The tickets of the visible tasks, by task id. */
+  std::unordered_map<std::size_t, std::shared_ptr<tticket>> tickets_{};
+  /** The elements rendered in the current frame. */
+  std::map<std::size_t, ftxui::Element> rendered_{};
+
+  std::size_t selected_{0};
+  /** The first visible task. */
+  std::size_t first_{0};
+  /** The last visible task. */
+  std::size_t last_{0};
+  /** The area the layout gave the column in the last frame. */
+  ftxui::Box box_{};
+
+  ftxui::Element element_{};
+  tkey key_{};
+  bool dirty_{false};
+};
+
+} // namespace detail
@@ -1,57 +1,97 @@
 export module gui:configuration;
 import :helpers;
+import :statistics;
+import :worker;
 
 import ftxui;
 import data;
 import std;
 
-static ftxui::Element create_title(std::size_t id, const std::string &name,
+static ftxui::Element create_title(std::size_t id, std::string_view name,
                                    data::tcolor color) {
-  return ftxui::hbox({ftxui::text(std::format("{:3} ", id)),
+  return ftxui::hbox({ftxui::text(std::format("{:>3} ", data::format_id(id))),
                       detail::create_text(name, color)});
 }
 
-class tlabel final : public ftxui::ComponentBase {
+/**
+ * Returns the Active checkbox of @p active.
+ *
+ * The checkbox toggles @p active, then @p change applies the new state. While
+ * a job reads the state, like the board loading its tasks, the toggle is
+ * undone instead.
+ */
+static ftxui::Component create_active(bool &active,
+                                      std::function<void(bool)> change) {
+  ftxui::CheckboxOption option = ftxui::CheckboxOption::Simple();
+  option.on_change = [&active, change = std::move(change)] {
+    if (detail::state_read()) {
+      active = !active;
+      return;
+    }
+    change(active);
+  };
+  return ftxui::Checkbox("Active", std::addressof(active), std::move(option));
+}
+
+class tlabel final : public ftxui::ComponentBase, private detail::tcounted {
 public:
   explicit tlabel(const data::tlabel *label) {
     Add(ftxui::Renderer([=] {
       ftxui::Elements elements;
       elements.emplace_back(create_title(label->id, label->name, label->color));
       if (!label->description.empty())
-        elements.emplace_back(ftxui::text(label->description));
+        elements.emplace_back(ftxui::text(std::string{label->description}));
       return ftxui::vbox({elements}) | ftxui::border;
     }));
   }
 };
 
-class tproject final : public ftxui::ComponentBase {
+class tproject final : public ftxui::ComponentBase, private detail::tcounted {
 public:
   explicit tproject(const data::tproject *project)
-      : active_(ftxui::Checkbox(
-            // TODO const_cast is a hack
-            "Active", const_cast<bool *>(std::addressof(project->active)))) {
-    Add(ftxui::Renderer(active_, [=] {
+      : active_(project->active),
+        checkbox_(create_active(active_,
+                                [id = project->id](bool active) {
+                                  data::set_project_active(id, active);
+                                })),
+        subscription_(data::subscribe(
+            data::tentity::project, project->id, data::tattribute::active,
+            [this, project](const data::tchange &) {
+              active_ = project->active;
+            })) {
+    Add(ftxui::Renderer(checkbox_, [=, this] {
       ftxui::Elements elements;
       elements.emplace_back(
           create_title(project->id, project->name, project->color));
       if (!project->description.empty())
-        elements.emplace_back(ftxui::text(project->description));
-      elements.emplace_back(active_->Render());
+        elements.emplace_back(
+            ftxui::text(std::string{project->description}));
+      elements.emplace_back(checkbox_->Render());
       return ftxui::vbox({elements}) | ftxui::border;
     }));
   }
 
 private:
-  ftxui::Component active_;
+  /** A copy of the active field, the checkbox changes it through data. */
+  bool active_;
+  ftxui::Component checkbox_;
+  data::tsubscription subscription_;
 };
 
-class tgroup final : public ftxui::ComponentBase {
+class tgroup final : public ftxui::ComponentBase, private detail::tcounted {
 public:
   explicit tgroup(const data::tgroup *group)
-      : active_(ftxui::Checkbox(
-            // TODO const_cast is a hack
-            "Active", const_cast<bool *>(std::addressof(group->active)))) {
-    Add(ftxui::Renderer(active_, [=] {
+      : active_(group->active),
+        checkbox_(create_active(active_,
+                                [id = group->id](bool active) {
+                                  data::set_group_active(id, active);
+                                })),
+        subscription_(data::subscribe(
+            data::tentity::group, group->id, data::tattribute::active,
+            [this, group](const data::tchange &) {
+              active_ = group->active;
+            })) {
+    Add(ftxui::Renderer(checkbox_, [=, this] {
       ftxui::Elements elements;
       elements.emplace_back(create_title(group->id, group->name, group->color));
       {
@@ -60,14 +100,17 @@ public:
             create_title(project.id, project.name, project.color));
       }
       if (!group->description.empty())
-        elements.emplace_back(ftxui::text(group->description));
-      elements.emplace_back(active_->Render());
+        elements.emplace_back(ftxui::text(std::string{group->description}));
+      elements.emplace_back(checkbox_->Render());
       return ftxui::vbox({elements}) | ftxui::border;
     }));
   }
 
 private:
-  ftxui::Component active_;
+  /** A copy of the active field, the checkbox changes it through data. */
+  bool active_;
+  ftxui::Component checkbox_;
+  data::tsubscription subscription_;
 };
 
 template <class G, class E>
@@ -89,7 +132,8 @@ static void add_column(ftxui::Components &columns, const E &elements) {
 }
 
 export namespace detail {
-class tconfiguration final : public ftxui::ComponentBase {
+class tconfiguration final : public ftxui::ComponentBase,
+                             private detail::tcounted {
 public:
   tconfiguration()
       : labels_(load<tlabel>(data::get_state().labels)),
@@ -1,15 +1,100 @@
 export module gui;
 import :configuration;
 import :board;
+import :cache;
+import :idle;
+import :lazy;
+import :overlay;
+import :traced;
 
+import data;
 import ftxui;
 import std;
 
 export namespace gui {
 
 ftxui::Component board() { return std::make_shared<detail::tboard>(); }
+
+/**
+ * Sends the status changes of the board to @p sender.
+ *
+ * The application sets it when a server owns the board, so the board is a
+ * client of the server. A change is only shown when @p sender returns true.
+ */
+void set_status_sender(
+    std::function<bool(std::size_t, data::ttask::tstatus)> sender) {
+  detail::status_sender = std::move(sender);
+}
 ftxui::Component configuration() {
   return std::make_shared<detail::tconfiguration>();
 }
 
+/**
+ * Returns a component that calls @p builder the first time it is shown.
+ *
+ * This avoids building views, like a tab, that are never shown.
+ */
+ftxui::Component lazy(std::function<ftxui::Component()> builder) {
+  auto result = std::make_shared<detail::tlazy>(std::move(builder));
+  std::erase_if(detail::lazy_components,
+                [](const auto &component) { return component.expired(); });
+  detail::lazy_components.emplace_back(result);
+  return result;
+}
+
+/** The memory of the GUI above which release_hidden releases views. */
+inline constexpr std::size_t release_threshold = std::size_t{64} << 20;
+
+/**
+ * Destroys the views of the lazy components that are not shown, when the GUI
+ * uses more than @p threshold bytes.
+ *
+ * This reduces the memory usage, at the cost of rebuilding the views when
+ * they are shown again. The application calls it when the tab changes.
+ *
+ * Returns the number of views destroyed.
+ */
+std::size_t release_hidden(std::size_t threshold = release_threshold) {
+  detail::tmemory_usage usage = detail::memory_usage();
+  if (usage.components.capacity + usage.tasks.capacity +
+          usage.descriptions.capacity + usage.revisions.capacity <=
+      threshold)
+    return 0;
+
+  std::size_t result = 0;
+  for (const auto &component : detail::lazy_components)
+    if (auto lazy = component.lock(); lazy && lazy->release())
+      ++result;
+
+  return result;
+}
+
+/**
+ * Only renders @p component when an event or a state change requires it.
+ *
+ * Else the element of the previous render is reused, including its layout.
+ * Only drawing it remains.
+ */
+ftxui::Component idle(ftxui::Component component) {
+  return std::make_shared<detail::tidle>(std::move(component));
+}
+
+/**
+ * Adds a status bar with performance counters below @p component.
+ *
+ * The status bar is hidden until F2 is pressed.
+ */
+ftxui::Component overlay(ftxui::Component component) {
+  return std::make_shared<detail::toverlay>(std::move(component));
+}
+
+/**
+ * Wraps @p component in a tracing span for every frame and event.
+ *
+ * Does nothing unless tracing is enabled with KABAN_TRACE.
+ */
+ftxui::Component traced(ftxui::Component component) {
+  return std::make_shared<detail::ttraced>(std::move(component));
+}
+
 } // namespace gui
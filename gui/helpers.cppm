@@ -5,8 +5,8 @@ import std;
 
 // TODO Tune foreground colours further.
 export namespace detail {
-ftxui::Element create_text(std::string text, data::tcolor color) {
-  ftxui::Element result = ftxui::text(text);
+ftxui::Element create_text(std::string_view text, data::tcolor color) {
+  ftxui::Element result = ftxui::text(std::string{text});
   switch (color) {
   case data::tcolor::black:
     return result;
@@ -51,14 +51,15 @@ ftxui::Element create_text(std::string text, data::tcolor color) {
   }
 }
 
-ftxui::Element create_label(std::string text, data::tcolor color) {
-  return create_text("[" + text + "]", color);
+ftxui::Element create_label(std::string_view text, data::tcolor color) {
+  return create_text(std::format("[{}]", text), color);
 }
 
 ftxui::Component create_title(const data::ttask *task) {
   return ftxui::Renderer([=] {
     ftxui::Elements result;
-    result.push_back(ftxui::text(std::format("{:3} ", task->id)));
+    result.push_back(
+        ftxui::text(std::format("{:>3} ", data::format_id(task->id))));
 
     if (std::size_t project_id =
             task->group ? data::get_group(task->group).project : task->project;
@@ -75,7 +76,7 @@ ftxui::Component create_title(const data::ttask *task) {
 
     // TODO ugly spacing hack.
     result.push_back(ftxui::text(" "));
-    result.push_back(ftxui::text(task->title));
+    result.push_back(ftxui::text(std::string{task->title}));
 
     if (task->labels.empty())
       return ftxui::hflow(result);
@@ -0,0 +1,54 @@
+export module gui:idle;
+import :statistics;
+import ftxui;
+import std;
+
+export namespace detail {
+
+/**
+ * Only renders its child when something changed.
+ *
+ * FTXUI draws a frame after every event. This component returns the element
+ * of the previous frame, unless:
+ * - the child handled the event,
+ * - the event is a mouse event, these change the hover state without being
+ *   handled,
+ * - the event is a custom event, these are posted by the worker and the timer
+ *   after changing the state,
+ * - the terminal has been resized.
+ *
+ * Unhandled key presses, like a key without a binding, and the cursor
+ * position reports of the terminal no longer render the board. FTXUI still
+ * draws a frame for them, but the reused element keeps its layout, see
+ * ftxui::cache_layout, and ftxui::tdamage_output writes nothing when no cell
+ * changed. Without events FTXUI does not draw at all.
+ */
+class tidle final : public ftxui::ComponentBase, private tcounted {
+public:
+  explicit tidle(ftxui::Component child) { Add(std::move(child)); }
+
+  ftxui::Element Render() override {
+    ftxui::Dimensions size = ftxui::Terminal::Size();
+    if (!element_ || dirty_ || size.dimx != size_.dimx ||
+        size.dimy != size_.dimy) {
+      element_ = ftxui::cache_layout(ComponentBase::Render());
+      size_ = size;
+      dirty_ = false;
+    }
+    return element_;
+  }
+
+  bool OnEvent(ftxui::Event event) override {
+    bool result = ComponentBase::OnEvent(event);
+    dirty_ = dirty_ || result || event.is_mouse() ||
+             event == ftxui::Event::Custom;
+    return result;
+  }
+
+private:
+  ftxui::Element element_{};
+  ftxui::Dimensions size_{};
+  bool dirty_{false};
+};
+
+} // namespace detail
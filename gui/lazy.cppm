@@ -0,0 +1,63 @@
+export module gui:lazy;
+import :statistics;
+import ftxui;
+import std;
+
+export namespace detail {
+
+/**
+ * A component that builds its child the first time it is shown.
+ *
+ * In a tab container only the selected tab is rendered, so the unselected
+ * tabs don't cost anything until they are selected.
+ */
+class tlazy final : public ftxui::ComponentBase, private tcounted {
+public:
+  explicit tlazy(std::function<ftxui::Component()> builder)
+      : builder_(std::move(builder)) {}
+
+  ftxui::Element Render() override {
+    build();
+    return ComponentBase::Render();
+  }
+
+  bool OnEvent(ftxui::Event event) override {
+    if (ChildCount() == 0)
+      return false;
+
+    return ComponentBase::OnEvent(std::move(event));
+  }
+
+  // Before the child has been built it is unknown whether it is focusable.
+  bool Focusable() const override {
+    return ChildCount() == 0 || ComponentBase::Focusable();
+  }
+
+  /**
+   * Destroys the child when it is not shown.
+   *
+   * The child is rebuilt the next time it is shown, so its state, like the
+   * selected ticket, is lost.
+   *
+   * Returns whether the child was destroyed.
+   */
+  bool release() {
+    if (ChildCount() == 0 || Active())
+      return false;
+
+    DetachAllChildren();
+    return true;
+  }
+
+private:
+  void build() {
+    if (ChildCount() == 0)
+      Add(builder_());
+  }
+
+  std::function<ftxui::Component()> builder_;
+};
+
+std::vector<std::weak_ptr<tlazy>> lazy_components;
+
+} // namespace detail
@@ -0,0 +1,166 @@
+export module gui:overlay;
+import :cache;
+import :statistics;
+import data;
+import ftxui;
+import std;
+
+/** The last samples of a duration. */
+template <std::size_t N> class tsamples {
+public:
+  using tduration = std::chrono::steady_clock::duration;
+
+  void add(tduration sample) {
+    samples_[next_] = sample;
+    next_ = (next_ + 1) % N;
+    size_ = std::min(size_ + 1, N);
+  }
+
+  [[nodiscard]] tduration last() const {
+    return size_ == 0 ? tduration{} : samples_[(next_ + N - 1) % N];
+  }
+
+  /** Returns the @p percentile, in the range [0, 100], of the samples. */
+  [[nodiscard]] tduration percentile(std::size_t percentile) const {
+    if (size_ == 0)
+      return {};
+
+    std::array<tduration, N> sorted = samples_;
+    auto nth = sorted.begin() +
+               static_cast<std::ptrdiff_t>((size_ - 1) * percentile / 100);
+    std::ranges::nth_element(sorted.begin(), nth,
+                             sorted.begin() +
+                                 static_cast<std::ptrdiff_t>(size_));
+    return *nth;
+  }
+
+private:
+  std::array<tduration, N> samples_{};
+  std::size_t next_{0};
+  std::size_t size_{0};
+};
+
+static std::string
+format_duration(std::chrono::steady_clock::duration duration) {
+  return std::format(
+      "{:.2f}ms", std::chrono::duration<double, std::milli>{duration}.count());
+}
+
+static std::string format_bytes(std::size_t bytes) {
+  if (bytes < 1024)
+    return std::format("{}B", bytes);
+  if (bytes < 1024 * 1024)
+    return std::format("{:.1f}KiB", static_cast<double>(bytes) / 1024);
+  return std::format("{:.1f}MiB", static_cast<double>(bytes) / (1024 * 1024));
+}
+
+/** Formats @p memory as its capacity and its number of objects. */
+static std::string format_memory(std::string_view name,
+                                 const data::tmemory &memory) {
+  return std::format("{} {} ({})", name, format_bytes(memory.capacity),
+                     memory.count);
+}
+
+export namespace detail {
+
+/**
+ * Shows the performance of the GUI in a status bar below its child.
+ *
+ * The status bar shows the time to render a frame, the latency from
+ * receiving a handled event to the end of rendering the next frame, the
+ * number of visible tickets and the number of live components. A second line
+ * shows the memory of the state and of the GUI, it is updated every second.
+ * The key F2 toggles the status bar. The samples are collected while the
+ * status bar is hidden.
+ */
+class toverlay final : public ftxui::ComponentBase, private tcounted {
+  using tclock = std::chrono::steady_clock;
+
+public:
+  explicit toverlay(ftxui::Component child) { Add(std::move(child)); }
+
+  ftxui::Element Render() override {
+    statistics.visible_tickets = 0;
+
+    tclock::time_point start = tclock::now();
+    ftxui::Element result = ComponentBase::Render();
+    tclock::time_point end = tclock::now();
+
+    frames_.add(end - start);
+    if (event_) {
+      latencies_.add(end - *event_);
+      event_.reset();
+    }
+
+    if (!visible_)
+      return result;
+
+    if (end - memory_time_ > std::chrono::seconds{1}) {
+      state_memory_ = data::memory_usage(data::get_state());
+      gui_memory_ = memory_usage();
+      memory_time_ = end;
+    }
+    return ftxui::vbox({result | ftxui::yflex, status_bar(), memory_bar()});
+  }
+
+  bool OnEvent(ftxui::Event event) override {
+    tclock::time_point now = tclock::now();
+    bool result = handle(std::move(event));
+    // An unhandled event, like a cursor position report, does not render a
+    // frame, see tidle. Its latency would include the time until the next
+    // frame.
+    if (result && !event_)
+      event_ = now;
+    return result;
+  }
+
+private:
+  bool handle(ftxui::Event event) {
+    if (event == ftxui::Event::F2) {
+      visible_ = !visible_;
+      return true;
+    }
+
+    return ComponentBase::OnEvent(std::move(event));
+  }
+
+  ftxui::Element status_bar() const {
+    return ftxui::text(std::format(
+        "frame {} p50 {} p99 {} | latency {} p50 {} p99 {} | tickets {} | "
+        "components {}",
+        format_duration(frames_.last()),
+        format_duration(frames_.percentile(50)),
+        format_duration(frames_.percentile(99)),
+        format_duration(latencies_.last()),
+        format_duration(latencies_.percentile(50)),
+        format_duration(latencies_.percentile(99)),
+        statistics.visible_tickets, statistics.components));
+  }
+
+  ftxui::Element memory_bar() const {
+    return ftxui::text(std::format(
+        "state {} {} {} {} | gui {} {} {} {} {}",
+        format_memory("records", state_memory_.records),
+        format_memory("strings", state_memory_.strings),
+        format_memory("ids", state_memory_.ids),
+        format_memory("archive", state_memory_.archive),
+        format_memory("components", gui_memory_.components),
+        format_memory("tasks", gui_memory_.tasks),
+        format_memory("elements", gui_memory_.elements),
+        format_memory("descriptions", gui_memory_.descriptions),
+        format_memory("revisions", gui_memory_.revisions)));
+  }
+
+  bool visible_{false};
+  tsamples<256> frames_{};
+  tsamples<256> latencies_{};
+  /** The time the first handled event after the last frame was received. */
+  std::optional<tclock::time_point> event_{};
+
+  /** The time the memory was last measured. */
+  tclock::time_point memory_time_{};
+  data::tmemory_usage state_memory_{};
+  tmemory_usage gui_memory_{};
+};
+
+} // namespace detail
@@ -0,0 +1,110 @@
+export module gui:statistics;
+import data;
+import std;
+
+export namespace detail {
+
+/**
+ * The counters shown in the overlay.
+ *
+ * The counters are only updated on the UI thread.
+ */
+struct tstatistics {
+  /** The number of components alive, see tcounted. */
+  std::size_t components{0};
+  /** The number of tickets shown in the current frame. */
+  std::size_t visible_tickets{0};
+};
+
+tstatistics statistics;
+
+/**
+ * Counts the instances in tstatistics::components.
+ *
+ * The components of the GUI derive from this class, the components created
+ * by FTXUI itself are not counted.
+ */
+class tcounted {
+public:
+  tcounted() { ++statistics.components; }
+  tcounted(const tcounted &) { ++statistics.components; }
+  tcounted &operator=(const tcounted &) = default;
+  ~tcounted() { --statistics.components; }
+};
+
+/** The memory of the GUI, by category. */
+struct tmemory_usage {
+  /**
+   * The components, see tcounted.
+   *
+   * The bytes only include the components that report their memory, without
+   * the FTXUI components they own.
+   */
+  data::tmemory components{};
+  /** The task lists of the columns and the state of the tickets per task. */
+  data::tmemory tasks{};
+  /**
+   * The cached elements.
+   *
+   * FTXUI doesn't expose the size of an element, so these are only counted.
+   */
+  data::tmemory elements{};
+  /** The cached layouts of the descriptions. */
+  data::tmemory descriptions{};
+  /** The revisions of the changed records. */
+  data::tmemory revisions{};
+};
+
+/**
+ * Returns the memory of the unordered map @p map.
+ *
+ * A node is estimated as its value, a next pointer, and the cached hash, like
+ * in the common standard libraries.
+ */
+template <class Map> data::tmemory unordered_memory(const Map &map) {
+  using tvalue = Map::value_type;
+  return {.count = map.size(),
+          .size = map.size() * sizeof(tvalue),
+          .capacity = map.size() * (sizeof(tvalue) + 2 * sizeof(void *)) +
+                      map.bucket_count() * sizeof(void *)};
+}
+
+/** Returns the memory of the vector @p vector. */
+template <class Vector> data::tmemory vector_memory(const Vector &vector) {
+  using tvalue = Vector::value_type;
+  return {.count = vector.size(),
+          .size = vector.size() * sizeof(tvalue),
+          .capacity = vector.capacity() * sizeof(tvalue)};
+}
+
+/** Adds the @p size bytes of a component object to @p usage. */
+void account_component(tmemory_usage &usage, std::size_t size) {
+  usage.components.size += size;
+  usage.components.capacity += size;
+}
+
+class taccounted;
+
+/** The components reporting their memory. */
+std::vector<const taccounted *> accounted;
+
+/**
+ * A component reporting its memory, see memory_usage.
+ *
+ * Only the long-lived components that own a substantial amount of memory
+ * derive from this class. Registering is a push_back and unregistering a
+ * linear search, so the components created while scrolling, like the
+ * tickets, are accounted by their owner instead.
+ */
+class taccounted {
+public:
+  taccounted() { accounted.push_back(this); }
+  taccounted(const taccounted &) : taccounted() {}
+  taccounted &operator=(const taccounted &) = default;
+  virtual ~taccounted() { std::erase(accounted, this); }
+
+  /** Adds the memory of the component to @p usage. */
+  virtual void account(tmemory_usage &usage) const = 0;
+};
+
+} // namespace detail
@@ -0,0 +1,154 @@
+export module gui:ticket;
+import :cache;
+import :helpers;
+import :statistics;
+import ftxui;
+import data;
+import std;
+
+export namespace detail {
+
+/** A ticket is accounted by its column, see taccounted. */
+class tticket final : public ftxui::ComponentBase, private tcounted {
+public:
+  /**
+   * @param show_description Whether the description is shown. The board owns
+   * this state, so it survives destroying and recreating the ticket.
+   * @param move Called with -1 or 1 to move the task to the previous or next
+   * status.
+   */
+  tticket(const data::ttask *task, bool &show_description,
+          std::function<void(int)> move)
+      : task_(task), show_description_(std::addressof(show_description)),
+        move_(std::move(move)) {
+
+    ftxui::Components result;
+    result.push_back(create_title(task_));
+    if (!task_->description.empty()) {
+      result.push_back(ftxui::Container::Horizontal(
+          {ftxui::Checkbox("", show_description_),
+           ftxui::Renderer([&] {
+             return description(*task_, description_width()) | ftxui::xflex |
+                    ftxui::reflect(description_box_);
+           }) | ftxui::Maybe(show_description_)}));
+    }
+
+    if (!task_->dependencies.empty()) {
+      result.push_back(ftxui::Renderer([&] {
+        ftxui::Elements blockers;
+        for (auto id : task_->dependencies)
+          blockers.push_back(ftxui::text(
+              std::format("{:>3} {}", data::format_id(id),
+                          data::get_task(id).title)));
+
+        return ftxui::window(ftxui::text("Dependencies"),
+                             ftxui::vbox(std::move(blockers)));
+      }));
+    }
+
+    if (!task_->requirements.empty()) {
+      result.push_back(ftxui::Renderer([&] {
+        ftxui::Elements blockers;
+        for (auto id : task_->requirements)
+          blockers.push_back(ftxui::text(
+              std::format("{:>3} {}", data::format_id(id),
+                          data::get_group(id).name)));
+
+        return ftxui::window(ftxui::text("Requirements"),
+                             ftxui::vbox(std::move(blockers)));
+      }));
+    }
+
+    if (task_->after) {
+      //  red when blocking?
+      result.push_back(ftxui::Renderer([&] {
+        return ftxui::window(
+            ftxui::text("After"),
+            ftxui::text(std::format("{:%Y.%m.%d}", *task_->after)));
+      }));
+    }
+
+    widget_ = ftxui::Container::Vertical(result) | ftxui::border;
+  }
+
+  /**
+   * Returns the element of the ticket.
+   *
+   * The element is cached and only rebuilt when the task, a record shown on
+   * the ticket, or the state of the ticket changes.
+   */
+  ftxui::Element Render() override {
+    tkey key{.stamp = stamp(*task_),
+             .focused = Focused(),
+             .show_description = *show_description_,
+             .width = description_width()};
+    if (!element_ || dirty_ || key != key_) {
+      element_ = widget_->Render();
+      key_ = key;
+      dirty_ = false;
+    }
+    return element_;
+  }
+
+  bool OnEvent(ftxui::Event event) override {
+    if (event == ftxui::Event::Character('<')) {
+      move_(-1);
+      return true;
+    }
+    if (event == ftxui::Event::Character('>')) {
+      move_(1);
+      return true;
+    }
+
+    // Mouse events can change the hover state of the checkbox without being
+    // handled.
+    bool result = widget_->OnEvent(event);
+    dirty_ = dirty_ || result || event.is_mouse();
+    return result;
+  }
+
+  bool Focusable() const override { return true; }
+
+  /** Forces the next Render to rebuild the element. */
+  void invalidate() { dirty_ = true; }
+
+  void account(tmemory_usage &usage) const {
+    account_component(usage, sizeof(*this));
+    usage.elements.count += element_ ? 1 : 0;
+  }
+
+private:
+  /**
+   * Returns the width available for the description in the last frame.
+   *
+   * Before the first frame the width in the widest column is used; that is
+   * 66 columns minus the borders of the ticket and the checkbox.
+   */
+  int description_width() const {
+    if (description_box_.x_max <= description_box_.x_min)
+      return 62;
+    return description_box_.x_max - description_box_.x_min + 1;
+  }
+
+  /** The state the cached element depends on. */
+  struct tkey {
+    std::size_t stamp{0};
+    bool focused{false};
+    bool show_description{false};
+    int width{0};
+
+    bool operator==(const tkey &) const = default;
+  };
+
+  const data::ttask *task_;
+  bool *show_description_;
+  std::function<void(int)> move_;
+  ftxui::Component widget_;
+  ftxui::Box description_box_{};
+
+  ftxui::Element element_{};
+  tkey key_{};
+  bool dirty_{false};
+};
+
+} // namespace detail
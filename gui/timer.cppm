@@ -0,0 +1,47 @@
+export module gui:timer;
+import ftxui;
+import std;
+
+export namespace detail {
+
+/**
+ * Calls a function on the UI thread at a given time.
+ *
+ * The thread of the timer sleeps until the time, so a waiting timer costs no
+ * CPU time.
+ */
+class ttimer {
+public:
+  /**
+   * Calls @p callback at @p time, replaces the previously scheduled call.
+   *
+   * The callback is dropped when no screen is active at @p time.
+   */
+  void schedule(std::chrono::system_clock::time_point time,
+                std::function<void()> callback) {
+    // Assigning stops and joins the previous thread.
+    thread_ = std::jthread{[time, callback = std::move(callback)](
+                               std::stop_token stop) mutable {
+      std::mutex mutex;
+      std::condition_variable_any condition;
+      std::unique_lock lock{mutex};
+      condition.wait_until(lock, stop, time, [] { return false; });
+      if (stop.stop_requested())
+        return;
+
+      if (ftxui::ScreenInteractive *screen =
+              ftxui::ScreenInteractive::Active()) {
+        screen->Post(std::move(callback));
+        screen->PostEvent(ftxui::Event::Custom);
+      }
+    }};
+  }
+
+  /** Drops the scheduled call. */
+  void cancel() { thread_ = std::jthread{}; }
+
+private:
+  std::jthread thread_{};
+};
+
+} // namespace detail
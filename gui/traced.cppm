@@ -0,0 +1,25 @@
+export module gui:traced;
+import :statistics;
+import ftxui;
+import std;
+import trace;
+
+export namespace detail {
+
+/** Records a tracing span for every frame rendered and event handled. */
+class ttraced final : public ftxui::ComponentBase, private tcounted {
+public:
+  explicit ttraced(ftxui::Component child) { Add(std::move(child)); }
+
+  ftxui::Element Render() override {
+    trace::tspan span{"Render"};
+    return ComponentBase::Render();
+  }
+
+  bool OnEvent(ftxui::Event event) override {
+    trace::tspan span{"OnEvent"};
+    return ComponentBase::OnEvent(std::move(event));
+  }
+};
+
+} // namespace detail
@@ -0,0 +1,183 @@
+export module gui:worker;
+import ftxui;
+import std;
+
+/** The number of jobs reading the state, see detail::tstate_reader. */
+static std::atomic<std::size_t> state_readers{0};
+
+export namespace detail {
+
+/**
+ * Marks the state as being read by a job on a worker thread.
+ *
+ * Create the mark before submitting the job and let the job own it, so it is
+ * released when the job is done. The UI thread does not change the state
+ * while it is marked, see state_read.
+ */
+class tstate_reader {
+public:
+  tstate_reader() { ++state_readers; }
+  tstate_reader(const tstate_reader &) = delete;
+  tstate_reader &operator=(const tstate_reader &) = delete;
+  ~tstate_reader() { --state_readers; }
+};
+
+/** Returns whether a job is reading the state on a worker thread. */
+[[nodiscard]] bool state_read() { return state_readers != 0; }
+
+/**
+ * A pool of threads running expensive computations for the GUI.
+ *
+ * A job runs on a worker thread and returns a function that handles its
+ * result. That function is posted to the active screen, so it runs on the UI
+ * thread and can modify components.
+ *
+ * Jobs are identified by a key. Submitting a job drops the queued job with the
+ * same key and asks the running job with the same key to stop. Only the
+ * result of the last job submitted for a key is handled. The keys contain
+ * the address of their owner, so the entry of a key is erased when its last
+ * job is complete.
+ */
+class tworker {
+public:
+  /**
+   * A job, it returns the function handling its result on the UI thread.
+   *
+   * The job should return early when a stop is requested, its result is
+   * dropped anyway. Returning an empty function drops the result as well.
+   */
+  using tjob = std::function<std::function<void()>(std::stop_token)>;
+
+  explicit tworker(std::size_t threads) {
+    for (std::size_t i = 0; i < threads; ++i)
+      threads_.emplace_back([this](std::stop_token stop) { run(stop); });
+  }
+
+  /**
+   * Submits @p job.
+   *
+   * Without an active screen, like in the benchmarks, there is no UI thread
+   * to post the result to. Then the job and its result are handled
+   * immediately on the calling thread.
+   */
+  void submit(std::string key, tjob job) {
+    if (!ftxui::ScreenInteractive::Active()) {
+      if (std::function<void()> done = job(std::stop_token{}); done)
+        done();
+      return;
+    }
+
+    std::scoped_lock lock{mutex_};
+    tentry &entry = entries_[key];
+    ++entry.generation;
+    if (entry.running)
+      entry.running->request_stop();
+
+    auto iter = std::ranges::find(queue_, key, &tqueued::key);
+    if (iter != queue_.end()) {
+      iter->job = std::move(job);
+      iter->generation = entry.generation;
+    } else {
+      queue_.push_back(tqueued{.key = std::move(key),
+                               .job = std::move(job),
+                               .generation = entry.generation});
+      condition_.notify_one();
+    }
+  }
+
+private:
+  struct tqueued {
+    std::string key{};
+    tjob job{};
+    std::size_t generation{0};
+  };
+
+  struct tentry {
+    /** The generation of the last submitted job. */
+    std::size_t generation{0};
+    /** Stops the running job. */
+    std::optional<std::stop_source> running{};
+  };
+
+  void run(std::stop_token stop) {
+    while (true) {
+      tqueued job;
+      std::stop_source source;
+      {
+        std::unique_lock lock{mutex_};
+        if (!condition_.wait(lock, stop, [&] { return !queue_.empty(); }))
+          return;
+
+        job = std::move(queue_.front());
+        queue_.pop_front();
+        entries_[job.key].running = source;
+      }
+
+      std::function<void()> done = job.job(source.get_token());
+      bool handled = done && !source.stop_requested();
+      {
+        std::scoped_lock lock{mutex_};
+        auto iter = entries_.find(job.key);
+        if (iter->second.running == source)
+          iter->second.running.reset();
+        // Without a result to handle the last job of the key is complete.
+        if (!handled && iter->second.generation == job.generation)
+          entries_.erase(iter);
+      }
+
+      if (handled)
+        post(std::move(job.key), job.generation, std::move(done));
+    }
+  }
+
+  /**
+   * Returns whether @p generation is the last job submitted for @p key.
+   *
+   * The last job is complete then, its entry is erased.
+   */
+  bool complete(const std::string &key, std::size_t generation) {
+    std::scoped_lock lock{mutex_};
+    auto iter = entries_.find(key);
+    if (iter == entries_.end() || iter->second.generation != generation)
+      return false;
+
+    entries_.erase(iter);
+    return true;
+  }
+
+  void post(std::string key, std::size_t generation,
+            std::function<void()> done) {
+    ftxui::ScreenInteractive *screen = ftxui::ScreenInteractive::Active();
+    if (!screen) {
+      complete(key, generation);
+      return;
+    }
+
+    screen->Post([this, key = std::move(key), generation,
+                  done = std::move(done)] {
+      // A newer job has been submitted after this job started.
+      if (complete(key, generation))
+        done();
+    });
+    // Make sure the screen is redrawn with the result.
+    screen->PostEvent(ftxui::Event::Custom);
+  }
+
+  std::mutex mutex_{};
+  std::condition_variable_any condition_{};
+  std::deque<tqueued> queue_{};
+  std::unordered_map<std::string, tentry> entries_{};
+
+  /** Declared last, so the threads are joined before the other members die. */
+  std::vector<std::jthread> threads_{};
+};
+
+/** Returns the worker pool of the GUI. */
+tworker &worker() {
+  // Leave a core for the UI thread, hardware_concurrency may return 0.
+  static tworker result{
+      std::max(2U, std::thread::hardware_concurrency()) - 1U};
+  return result;
+}
+
+} // namespace detail
@@ -1,3 +1,4 @@
+import cli;
 import data;
 import ftxui;
 import gui;
@@ -7,43 +8,58 @@ import std;
 // up properly. Enable this to force a rebuild, if needed.
 [[maybe_unused]] static const char *generaton = __TIME__;
 
-int main() {
-  char *home = std::getenv("HOME");
-  std::ifstream file{home + std::string{"/kaban"}};
+int main(int argc, const char *argv[]) {
+  if (argc > 1)
+    return cli::run(std::span{argv + 1, static_cast<std::size_t>(argc - 1)});
 
-  std::string input{std::istreambuf_iterator<char>(file), {}};
-  std::expected<std::unique_ptr<data::tstate>, data::tparse_error> result =
-      data::parse(input);
-  if (!result) {
-    data::tparse_error error = std::move(result).error();
-    std::cerr << std::format(R"(Failed parsing
-{}:{}
-{}
-{}
-)",
-                             home + std::string{"/kaban"}, error.line_no,
-                             error.line, error.message);
-
-    return 1;
-  }
-  if (!data::set_state(std::move(result).value())) {
-    std::cerr << "Failed to store the state\n";
+  std::vector<std::string> paths = cli::default_paths();
+  if (!cli::load(paths))
     return 1;
-  }
+
+  // A running server owns the board, the board sends its changes to the
+  // server, which saves them and records the history. Without a server the
+  // changes are only shown. When the server stops the board keeps showing
+  // its changes.
+  if (paths.size() == 1 && cli::is_served(paths.front()))
+    gui::set_status_sender([path = paths.front()](
+                               std::size_t id, data::ttask::tstatus status) {
+      return cli::send_status(path, id, status).value_or(true);
+    });
 
   int tab = 0;
   std::vector<std::string> labels{"Board", "Configuration"};
+  // The hidden tab is released when the GUI uses a lot of memory.
+  ftxui::MenuOption tabs = ftxui::MenuOption::Toggle();
+  tabs.on_change = [] { gui::release_hidden(); };
   ftxui::ScreenInteractive screen = ftxui::ScreenInteractive::Fullscreen();
-  screen.Loop(ftxui::Container::Vertical({
-                  ftxui::Button("Quit", screen.ExitLoopClosure()),
-                  // There seem to be some issues with the selection in
-                  // FTXUI:
-                  // - partly https://github.com/ArthurSonzogni/FTXUI/issues/523
-                  // - and another not yet investigated issue.
-                  ftxui::Toggle(std::addressof(labels), std::addressof(tab)),
-                  ftxui::Container::Tab({gui::board(), gui::configuration()},
-                                        std::addressof(tab)),
-              })             //
-              | ftxui::xflex //
-              | ftxui::border);
+  // Only write the changed cells, this matters for large terminals and remote
+  // sessions.
+  ftxui::tdamage_output output{screen};
+  // Idle decides whether a frame needs rendering, it wraps the overlay so the
+  // overlay only measures the frames actually rendered.
+  screen.Loop(gui::idle(gui::overlay(gui::traced(
+      ftxui::Container::Vertical({
+          ftxui::Button("Quit", screen.ExitLoopClosure()),
+          // There seem to be some issues with the selection in
+          // FTXUI:
+          // - partly https://github.com/ArthurSonzogni/FTXUI/issues/523
+          // - and another not yet investigated issue.
+          ftxui::Menu(std::addressof(labels), std::addressof(tab), tabs),
+          // Only build the tabs when they are selected.
+          ftxui::Container::Tab(
+              {gui::lazy(gui::board), gui::lazy(gui::configuration)},
+              std::addressof(tab)),
+      })             //
+      | ftxui::xflex //
+      | ftxui::border))));
+
+  if (std::getenv("KABAN_OUTPUT_STATISTICS")) {
+    const auto &statistics = output.statistics();
+    std::size_t frames = std::max(std::size_t{1}, statistics.frames);
+    std::println(std::cerr,
+                 "frames: {}, bytes per frame: {} before, {} after damage "
+                 "tracking",
+                 statistics.frames, statistics.input_bytes / frames,
+                 statistics.output_bytes / frames);
+  }
 }
@@ -0,0 +1,217 @@
+export module persistent;
+import std;
+
+export namespace persistent {
+
+/**
+ * A persistent vector.
+ *
+ * The vector is a trie with a fixed branching factor. Modifying the vector
+ * creates a new version, this copies the path from the root to the modified
+ * leaf and shares all other nodes with the original. So every version costs
+ * O(log n) extra memory and copying a vector is O(1).
+ *
+ * The elements are stored as shared pointers, this allows diff to compare
+ * elements by identity instead of by value.
+ */
+template <class T> class tvector {
+  static constexpr std::size_t bits = 5;
+  static constexpr std::size_t width = std::size_t{1} << bits;
+  static constexpr std::size_t mask = width - 1;
+
+  struct tnode {
+    /** The child nodes, only used in the inner nodes. */
+    std::vector<std::shared_ptr<const tnode>> children{};
+    /** The elements, only used in the leaf nodes. */
+    std::vector<std::shared_ptr<const T>> values{};
+  };
+
+public:
+  tvector() = default;
+
+  /** Creates the vector in one pass, without creating intermediate versions. */
+  template <std::ranges::input_range R> explicit tvector(R &&range) {
+    std::vector<std::shared_ptr<tnode>> nodes;
+    for (auto &&value : range) {
+      if (size_ % width == 0)
+        nodes.emplace_back(std::make_shared<tnode>());
+
+      nodes.back()->values.emplace_back(
+          std::make_shared<const T>(std::forward<decltype(value)>(value)));
+      ++size_;
+    }
+
+    if (nodes.empty())
+      return;
+
+    while (nodes.size() > 1) {
+      std::vector<std::shared_ptr<tnode>> parents;
+      for (std::size_t i = 0; i < nodes.size(); i += width) {
+        auto parent = std::make_shared<tnode>();
+        auto last = std::min(i + width, nodes.size());
+        parent->children.assign(nodes.begin() + static_cast<std::ptrdiff_t>(i),
+                                nodes.begin() +
+                                    static_cast<std::ptrdiff_t>(last));
+        parents.emplace_back(std::move(parent));
+      }
+      nodes = std::move(parents);
+      shift_ += bits;
+    }
+    root_ = std::move(nodes.front());
+  }
+
+  [[nodiscard]] std::size_t size() const { return size_; }
+  [[nodiscard]] bool empty() const { return size_ == 0; }
+
+  [[nodiscard]] const T &operator[](std::size_t index) const {
+    return *leaf(index)->values[index & mask];
+  }
+
+  [[nodiscard]] const T &at(std::size_t index) const {
+    if (index >= size_)
+      throw std::out_of_range("persistent::tvector::at");
+    return (*this)[index];
+  }
+
+  /** Returns a new version with the element at @p index replaced. */
+  [[nodiscard]] tvector set(std::size_t index, T value) const {
+    if (index >= size_)
+      throw std::out_of_range("persistent::tvector::set");
+
+    tvector result{*this};
+    result.root_ = update(root_.get(), shift_, index,
+                          std::make_shared<const T>(std::move(value)));
+    return result;
+  }
+
+  /** Returns a new version with @p value appended. */
+  [[nodiscard]] tvector push_back(T value) const {
+    tvector result{*this};
+    if (root_ && size_ == (width << shift_)) {
+      // The trie is full, add a level.
+      auto root = std::make_shared<tnode>();
+      root->children.emplace_back(root_);
+      result.root_ = std::move(root);
+      result.shift_ += bits;
+    }
+    result.root_ = update(result.root_.get(), result.shift_, size_,
+                          std::make_shared<const T>(std::move(value)));
+    ++result.size_;
+    return result;
+  }
+
+  /** Calls @p f with every element in order. */
+  template <class F> void for_each(F f) const {
+    if (root_)
+      visit(*root_, shift_, f);
+  }
+
+  /**
+   * Calls @p f with the index of every element that differs between this
+   * version and @p other.
+   *
+   * Subtrees shared between the versions are skipped, so the cost depends on
+   * the number of changes, not on the size of the vectors.
+   */
+  template <class F> void diff(const tvector &other, F f) const {
+    diff_nodes({root_.get(), shift_}, {other.root_.get(), other.shift_},
+               std::max(shift_, other.shift_), 0, f);
+  }
+
+private:
+  const tnode *leaf(std::size_t index) const {
+    const tnode *node = root_.get();
+    for (std::size_t level = shift_; level > 0; level -= bits)
+      node = node->children[(index >> level) & mask].get();
+    return node;
+  }
+
+  static std::shared_ptr<const tnode> update(const tnode *node,
+                                             std::size_t level,
+                                             std::size_t index,
+                                             std::shared_ptr<const T> value) {
+    auto result =
+        node ? std::make_shared<tnode>(*node) : std::make_shared<tnode>();
+
+    if (level == 0) {
+      std::size_t slot = index & mask;
+      if (slot == result->values.size())
+        result->values.emplace_back(std::move(value));
+      else
+        result->values[slot] = std::move(value);
+    } else {
+      std::size_t slot = (index >> level) & mask;
+      if (slot == result->children.size())
+        result->children.emplace_back();
+      result->children[slot] = update(result->children[slot].get(),
+                                      level - bits, index, std::move(value));
+    }
+    return result;
+  }
+
+  template <class F>
+  static void visit(const tnode &node, std::size_t level, F &f) {
+    if (level == 0)
+      for (const auto &value : node.values)
+        f(*value);
+    else
+      for (const auto &node_child : node.children)
+        visit(*node_child, level - bits, f);
+  }
+
+  /** A node and the level it lives at in its own trie. */
+  struct tref {
+    const tnode *node;
+    std::size_t level;
+  };
+
+  /**
+   * Returns the child at @p slot of @p ref when it is visited at @p level.
+   *
+   * When the tries have a different height the root of the lower trie is the
+   * first child of the virtual nodes above it.
+   */
+  static tref child(tref ref, std::size_t level, std::size_t slot) {
+    if (!ref.node)
+      return {nullptr, level - bits};
+
+    if (ref.level < level)
+      return slot == 0 ? ref : tref{nullptr, level - bits};
+
+    return {slot < ref.node->children.size() ? ref.node->children[slot].get()
+                                             : nullptr,
+            level - bits};
+  }
+
+  template <class F>
+  static void diff_nodes(tref lhs, tref rhs, std::size_t level,
+                         std::size_t base, F &f) {
+    if (lhs.node == rhs.node && lhs.level == rhs.level)
+      return;
+
+    if (level == 0) {
+      std::size_t lhs_size = lhs.node ? lhs.node->values.size() : 0;
+      std::size_t rhs_size = rhs.node ? rhs.node->values.size() : 0;
+      for (std::size_t i = 0; i < std::max(lhs_size, rhs_size); ++i)
+        if (i >= lhs_size || i >= rhs_size ||
+            lhs.node->values[i] != rhs.node->values[i])
+          f(base + i);
+      return;
+    }
+
+    for (std::size_t slot = 0; slot < width; ++slot) {
+      tref l = child(lhs, level, slot);
+      tref r = child(rhs, level, slot);
+      if (!l.node && !r.node)
+        continue;
+      diff_nodes(l, r, level - bits, base + (slot << level), f);
+    }
+  }
+
+  std::shared_ptr<const tnode> root_{};
+  /** The number of bits to shift the index for the root node. */
+  std::size_t shift_{0};
+  std::size_t size_{0};
+};
+
+} // namespace persistent
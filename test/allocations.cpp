@@ -0,0 +1,98 @@
+import ut_helpers;
+
+import allocations;
+import data;
+import ftxui;
+import gui;
+import trace;
+
+import boost.ut;
+
+import std;
+
+namespace {
+
+using namespace boost::ut::literals;
+
+/**
+ * Returns the input of the reference board.
+ *
+ * Every task uses most fields, so a per-field allocation shows up in the
+ * budget.
+ */
+std::string reference_board(std::size_t tasks) {
+  std::string result;
+  std::back_insert_iterator out{result};
+  for (std::size_t id = 1; id <= 10; ++id)
+    std::format_to(out, "[label]\nid={}\nname=label {}\ncolor=red\n\n", id, id);
+  for (std::size_t id = 1; id <= 5; ++id)
+    std::format_to(out, "[project]\nid={}\nname=project {}\n\n", id, id);
+  for (std::size_t id = 1; id <= 20; ++id)
+    std::format_to(out, "[group]\nid={}\nproject={}\nname=group {}\n\n", id,
+                   (id - 1) / 4 + 1, id);
+
+  for (std::size_t id = 1; id <= tasks; ++id) {
+    std::format_to(out, "[task]\nid={}\n", id);
+    if (id % 2)
+      std::format_to(out, "project={}\n", id % 5 + 1);
+    else
+      std::format_to(out, "group={}\n", id % 20 + 1);
+    std::format_to(out,
+                   "title=task {}\ndescription=<<<\nThe first line of the "
+                   "description.\nThe second line.\n>>>\nstatus={}\n"
+                   "labels={}, {}\n",
+                   id, data::status_names[id % data::status_names.size()],
+                   id % 10 + 1, (id + 3) % 10 + 1);
+    if (id > 1)
+      std::format_to(out, "dependencies={}\n", id / 2);
+    std::format_to(out, "\n");
+  }
+  return result;
+}
+
+/** Returns the allocations of rendering an unchanged board. */
+std::size_t frame_allocations(std::size_t tasks) {
+  expect_true(data::set_state(parse_state(reference_board(tasks))));
+
+  ftxui::Screen screen{200, 60};
+  ftxui::Component board = gui::board();
+  // The first frames fill the caches.
+  for (int i = 0; i < 2; ++i)
+    ftxui::Render(screen, board->Render());
+
+  return allocations::count([&] { ftxui::Render(screen, board->Render()); });
+}
+
+boost::ut::suite<"allocations"> suite = [] {
+  // Tracing records every span, that allocates.
+  if (trace::enabled)
+    return;
+
+  // The measured frames use the height of the columns in the layout of the
+  // screen. Only the first frame uses the terminal size, match it to the
+  // screen so the warm-up frames fill the same caches.
+  ftxui::Terminal::SetFallbackSize(ftxui::Dimensions{200, 60});
+
+  "parse"_test = [] {
+    // The records are allocated in the arena, so the allocations only grow
+    // with the number of times the arena grows.
+    constexpr std::size_t budget = 64;
+    for (std::size_t tasks : {std::size_t{1'000}, std::size_t{10'000}}) {
+      std::string input = reference_board(tasks);
+      std::size_t count = allocations::count([&] { parse_state(input); });
+      boost::ut::expect(boost::ut::le(count, budget)) << "tasks" << tasks;
+    }
+  };
+
+  "frame"_test = [] {
+    // An unchanged frame reuses the cached elements of the columns, so the
+    // allocations don't depend on the number of tasks.
+    constexpr std::size_t budget = 2'000;
+    std::size_t small = frame_allocations(1'000);
+    std::size_t large = frame_allocations(10'000);
+    boost::ut::expect(boost::ut::le(small, budget));
+    boost::ut::expect(boost::ut::le(large, small + 16));
+  };
+};
+
+} // namespace
@@ -0,0 +1,188 @@
+import ut_helpers;
+
+import analytics;
+import data;
+
+import boost.ut;
+
+import std;
+
+namespace {
+
+using namespace boost::ut::literals;
+using namespace std::chrono_literals;
+
+using tstatus = data::ttask::tstatus;
+
+constexpr std::chrono::sys_days day = 2024y / 1 / 10;
+constexpr std::chrono::sys_days next_day = day + std::chrono::days{1};
+
+analytics::ttransition transition(std::chrono::seconds time, std::size_t task,
+                                  tstatus from, tstatus to) {
+  return analytics::ttransition{
+      .time = std::chrono::sys_seconds{day} + time,
+      .task = task,
+      .from = from,
+      .to = to};
+}
+
+boost::ut::suite<"analytics"> suite = [] {
+  "format_and_parse"_test = [] {
+    analytics::ttransition expected =
+        transition(1h, 42, tstatus::backlog, tstatus::progress);
+    std::string line = analytics::format(expected);
+    boost::ut::expect(boost::ut::eq(
+        line, std::string{"1704848400 42 backlog progress\n"}));
+
+    std::optional<analytics::ttransition> result =
+        analytics::parse_transition(std::string_view{line}.substr(
+            0, line.size() - 1));
+    assert_false(!result);
+    expect_true(*result == expected);
+  };
+
+  "parse_history"_test = [] {
+    std::expected<std::vector<analytics::ttransition>, int> result =
+        analytics::parse_history("1 1 backlog selected\n"
+                                 "\n"
+                                 "2 1 selected progress\n"
+                                 "3 1 progress");
+    assert_false(!result);
+    // The incomplete last line is ignored.
+    boost::ut::expect(boost::ut::eq(result->size(), std::size_t{2}));
+  };
+
+  "parse_history_error"_test = [] {
+    std::expected<std::vector<analytics::ttransition>, int> result =
+        analytics::parse_history("1 1 backlog selected\n"
+                                 "2 1 selected unknown\n");
+    assert_false(result);
+    boost::ut::expect(boost::ut::eq(result.error(), 2));
+  };
+
+  "metrics"_test = [] {
+    data::ttask task{.id = 1,
+                     .project = 10,
+                     .group = 20,
+                     .title = "a",
+                     .labels = {30, 31}};
+
+    analytics::tmetrics metrics;
+    metrics.add(transition(0h, 1, tstatus::backlog, tstatus::selected), &task);
+    metrics.add(transition(2h, 1, tstatus::selected, tstatus::progress),
+                &task);
+    metrics.add(transition(26h, 1, tstatus::progress, tstatus::done), &task);
+    // Done without ever being in progress, no cycle time.
+    metrics.add(transition(0h, 2, tstatus::backlog, tstatus::done), nullptr);
+
+    analytics::tbucket board =
+        metrics.query(analytics::tdimension::board, 0, day, next_day);
+    boost::ut::expect(boost::ut::eq(board.done, std::size_t{2}));
+    boost::ut::expect(boost::ut::eq(board.cycles, std::size_t{1}));
+    expect_true(board.average_cycle_time() == std::chrono::seconds{24h});
+    expect_true(board.average_lead_time() == std::chrono::seconds{13h});
+
+    for (auto [dimension, id] :
+         {std::pair{analytics::tdimension::project, std::size_t{10}},
+          std::pair{analytics::tdimension::group, std::size_t{20}},
+          std::pair{analytics::tdimension::label, std::size_t{30}},
+          std::pair{analytics::tdimension::label, std::size_t{31}}}) {
+      analytics::tbucket bucket = metrics.query(dimension, id, day, next_day);
+      boost::ut::expect(boost::ut::eq(bucket.done, std::size_t{1}));
+      expect_true(bucket.lead_time == std::chrono::seconds{26h});
+    }
+
+    // The task was done on the second day.
+    expect_true(metrics.query(analytics::tdimension::project, 10, day, day) ==
+                analytics::tbucket{});
+    boost::ut::expect(boost::ut::eq(
+        metrics.query(analytics::tdimension::project, 10, next_day, next_day)
+            .done,
+        std::size_t{1}));
+  };
+
+  "grouped_task"_test = [] {
+    expect_true(data::set_state(parse_state(R"([project]
+id=10
+name=project
+
+[group]
+id=20
+project=10
+name=group
+
+[task]
+id=1
+group=20
+title=a
+)")));
+
+    analytics::tmetrics metrics;
+    metrics.add(transition(0h, 1, tstatus::backlog, tstatus::done),
+                std::addressof(data::get_task(1)));
+
+    // The task counts for the project of its group.
+    for (auto [dimension, id] :
+         {std::pair{analytics::tdimension::project, std::size_t{10}},
+          std::pair{analytics::tdimension::group, std::size_t{20}}})
+      boost::ut::expect(boost::ut::eq(
+          metrics.query(dimension, id, day, day).done, std::size_t{1}));
+  };
+
+  "add_history"_test = [] {
+    constexpr std::string_view history = "1704844800 1 backlog progress\n"
+                                         "1704931200 1 progress done\n"
+                                         "1704931200 2 backlog";
+    auto find = [](std::size_t) -> const data::ttask * { return nullptr; };
+
+    analytics::tmetrics metrics;
+    assert_false(!metrics.add_history(history, find));
+    // The incomplete last line is added once it is complete.
+    boost::ut::expect(boost::ut::eq(metrics.history_size(),
+                                    history.rfind('\n') + 1));
+    std::string appended = std::string{history} + " done\n";
+    assert_false(!metrics.add_history(
+        std::string_view{appended}.substr(metrics.history_size()), find));
+    boost::ut::expect(
+        boost::ut::eq(metrics.history_size(), appended.size()));
+    boost::ut::expect(boost::ut::eq(
+        metrics.query(analytics::tdimension::board, 0, day, next_day).done,
+        std::size_t{2}));
+  };
+
+  "serialize_and_parse"_test = [] {
+    data::ttask task{.id = 1, .project = 10, .title = "a", .labels = {30}};
+
+    analytics::tmetrics metrics;
+    metrics.add(transition(0h, 1, tstatus::backlog, tstatus::progress), &task);
+    metrics.add(transition(26h, 1, tstatus::progress, tstatus::done), &task);
+    metrics.add(transition(1h, 2, tstatus::backlog, tstatus::selected),
+                nullptr);
+
+    std::optional<analytics::tmetrics> result =
+        analytics::tmetrics::parse(metrics.serialize());
+    assert_false(!result);
+    boost::ut::expect(
+        boost::ut::eq(result->history_size(), metrics.history_size()));
+    for (auto [dimension, id] :
+         {std::pair{analytics::tdimension::board, std::size_t{0}},
+          std::pair{analytics::tdimension::project, std::size_t{10}},
+          std::pair{analytics::tdimension::label, std::size_t{30}}})
+      expect_true(result->query(dimension, id, day, next_day) ==
+                  metrics.query(dimension, id, day, next_day));
+
+    // The times of the tasks are kept, task 2 started after parsing.
+    result->add(transition(2h, 2, tstatus::selected, tstatus::progress),
+                nullptr);
+    result->add(transition(3h, 2, tstatus::progress, tstatus::done), nullptr);
+    analytics::tbucket board =
+        result->query(analytics::tdimension::board, 0, day, day);
+    expect_true(board.cycle_time == std::chrono::seconds{1h});
+    expect_true(board.lead_time == std::chrono::seconds{2h});
+
+    expect_false(analytics::tmetrics::parse("task 1 - -\n"));
+    expect_false(analytics::tmetrics::parse("history 0\nbucket week 0\n"));
+  };
+};
+
+} // namespace
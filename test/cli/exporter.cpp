@@ -0,0 +1,119 @@
+#include <unistd.h>
+
+import ut_helpers;
+
+import cli;
+import data;
+
+import boost.ut;
+
+import std;
+
+namespace {
+
+using namespace boost::ut::literals;
+
+/** Returns the output @p write writes to a cli::toutput. */
+template <class F> std::string capture(F write) {
+  std::array<int, 2> fds;
+  assert_false(::pipe(fds.data()));
+  {
+    // The output of the tests fits in the buffer of the pipe.
+    cli::toutput output{fds[1]};
+    write(output);
+  }
+  ::close(fds[1]);
+
+  std::string result;
+  std::array<char, 4096> chunk;
+  while (true) {
+    ssize_t count = ::read(fds[0], chunk.data(), chunk.size());
+    if (count <= 0)
+      break;
+    result.append(chunk.data(), static_cast<std::size_t>(count));
+  }
+  ::close(fds[0]);
+  return result;
+}
+
+data::tstate make_state(std::string_view title, std::string_view description) {
+  data::tstate result;
+  result.tasks.push_back(data::ttask{1, 0, 0, std::pmr::string{title},
+                                     std::pmr::string{description}});
+  return result;
+}
+
+boost::ut::suite<"exporter"> suite = [] {
+  "json_quotes_and_backslashes"_test = [] {
+    data::tstate state = make_state(R"(say "hi" \o/)", "");
+    std::string result = capture(
+        [&](cli::toutput &output) { cli::export_json(state, output); });
+    expect_true(result.contains(R"("title":"say \"hi\" \\o/")")) << result;
+  };
+
+  "json_control_characters"_test = [] {
+    data::tstate state = make_state("title", "a\nb\tc\x01\x1f\x7f");
+    std::string result = capture(
+        [&](cli::toutput &output) { cli::export_json(state, output); });
+    expect_true(
+        result.contains("\"description\":\"a\\nb\\tc\\u0001\\u001f\x7f\""))
+        << result;
+  };
+
+  "csv_plain"_test = [] {
+    data::tstate state = make_state("title", "text");
+    std::string result = capture(
+        [&](cli::toutput &output) { cli::export_csv(state, output); });
+    expect_true(result.ends_with("\r\n1,,,title,backlog,,,,,text\r\n"))
+        << result;
+  };
+
+  "csv_commas_and_quotes"_test = [] {
+    data::tstate state = make_state("a,b", R"(say "hi")");
+    std::string result = capture(
+        [&](cli::toutput &output) { cli::export_csv(state, output); });
+    expect_true(
+        result.ends_with("\r\n1,,,\"a,b\",backlog,,,,,\"say \"\"hi\"\"\"\r\n"))
+        << result;
+  };
+
+  "csv_line_breaks"_test = [] {
+    data::tstate state = make_state("cr\rlf\n", "line\r\nnext");
+    std::string result = capture(
+        [&](cli::toutput &output) { cli::export_csv(state, output); });
+    expect_true(result.ends_with(
+        "\r\n1,,,\"cr\rlf\n\",backlog,,,,,\"line\r\nnext\"\r\n"))
+        << result;
+  };
+
+  "archived_tasks"_test = [] {
+    data::tstate state = make_state("open", "");
+    state.archive.push_back(data::ttask{2, 0, 0, "old", ""});
+    state.archive.back().status = data::ttask::tstatus::done;
+    std::string json = capture(
+        [&](cli::toutput &output) { cli::export_json(state, output); });
+    expect_true(json.contains(R"({"id":2,"project":null,"group":null,)"
+                              R"("title":"old","status":"done")"))
+        << json;
+    std::string csv = capture(
+        [&](cli::toutput &output) { cli::export_csv(state, output); });
+    expect_true(csv.ends_with("\r\n2,,,old,done,,,,,\r\n")) << csv;
+  };
+
+  "board_ids"_test = [] {
+    data::tstate state = make_state("first", "");
+    state.boards = 2;
+    state.tasks.push_back(
+        data::ttask{data::board_id(1, 3), 0, 0, "second", ""});
+    state.tasks.back().dependencies.push_back(1);
+    std::string json = capture(
+        [&](cli::toutput &output) { cli::export_json(state, output); });
+    expect_true(json.contains(R"({"id":"1:3",)")) << json;
+    expect_true(json.contains(R"("dependencies":[1],)")) << json;
+    std::string csv = capture(
+        [&](cli::toutput &output) { cli::export_csv(state, output); });
+    expect_true(csv.ends_with("\r\n1:3,,,second,backlog,,,1,,\r\n")) << csv;
+  };
+};
+
+} // namespace
@@ -0,0 +1,144 @@
+import ut_helpers;
+
+import data;
+
+import boost.ut;
+
+import std;
+
+namespace {
+
+using namespace boost::ut::literals;
+
+constexpr std::string_view board = R"([project]
+id=1
+name=project
+
+[archive]
+ids=3, 2
+
+[task]
+id=1
+project=1
+title=active
+dependencies=2, 3
+)";
+
+constexpr std::string_view archive = R"([task]
+id=2
+project=1
+title=done
+status=done
+
+[task]
+id=3
+title=discarded
+status=discarded
+)";
+
+boost::ut::suite<"archive"> suite = [] {
+  "parse"_test = [] {
+    std::unique_ptr<data::tstate> state = parse_state(board);
+    expect_true(std::ranges::equal(state->archived,
+                                   std::array{std::size_t{2}, std::size_t{3}}));
+    expect_true(state->archive.empty());
+    expect_false(state->archive_loaded);
+  };
+
+  "active_and_archived"_test = [] {
+    std::expected<std::unique_ptr<data::tstate>, data::tparse_error> result =
+        data::parse(R"([archive]
+ids=1
+
+[task]
+id=1
+title=a
+)");
+    assert_false(result);
+    boost::ut::expect(
+        boost::ut::eq(result.error().message,
+                      std::string{"task »1« is both active and archived"}));
+  };
+
+  "blocked_without_loading"_test = [] {
+    std::size_t loads = 0;
+    data::set_archive_loader([&](data::tstate &) {
+      ++loads;
+      return false;
+    });
+    expect_true(data::set_state(parse_state(board)));
+
+    expect_false(data::is_blocked(data::get_task(1)));
+    boost::ut::expect(boost::ut::eq(loads, std::size_t{0}));
+    data::set_archive_loader({});
+  };
+
+  "load_on_reference"_test = [] {
+    data::set_archive_loader([](data::tstate &state) {
+      return !data::parse_archive(state, archive, 0);
+    });
+    expect_true(data::set_state(parse_state(board)));
+
+    expect_true(data::get_task(2).title == "done");
+    expect_true(data::get_state().archive_loaded);
+    boost::ut::expect(
+        boost::ut::eq(data::get_state().archive.size(), std::size_t{2}));
+
+    // A reopened archived task blocks again.
+    data::set_status(2, data::ttask::tstatus::review);
+    expect_true(data::is_blocked(data::get_task(1)));
+    data::set_archive_loader({});
+  };
+
+  "reopen_and_serialize"_test = [] {
+    data::set_archive_loader([](data::tstate &state) {
+      return !data::parse_archive(state, archive, 0);
+    });
+    expect_true(data::set_state(parse_state(board)));
+
+    // A reopened task moves back to the board.
+    data::set_status(2, data::ttask::tstatus::progress);
+    const data::tstate &state = data::get_state();
+    expect_true(std::ranges::equal(state.archived,
+                                   std::array{std::size_t{3}}));
+    boost::ut::expect(boost::ut::eq(state.archive.size(), std::size_t{1}));
+    boost::ut::expect(boost::ut::eq(state.tasks.size(), std::size_t{2}));
+
+    std::unique_ptr<data::tstate> result = parse_state(data::serialize(state));
+    expect_true(std::ranges::equal(result->archived,
+                                   std::array{std::size_t{3}}));
+    expect_false(data::parse_archive(*result, data::serialize_archive(state),
+                                     0));
+    boost::ut::expect(boost::ut::eq(result->archive.size(), std::size_t{1}));
+    auto task = std::ranges::find(result->tasks, std::size_t{2},
+                                  &data::ttask::id);
+    assert_false(task == result->tasks.end());
+    expect_eq(*task, state.tasks[1]);
+    data::set_archive_loader({});
+  };
+
+  "archive_and_serialize"_test = [] {
+    std::unique_ptr<data::tstate> state = parse_state(R"([task]
+id=1
+title=a
+
+[task]
+id=2
+title=b
+status=done
+)");
+    state->archive_loaded = true;
+    boost::ut::expect(boost::ut::eq(data::archive(*state), std::size_t{1}));
+    boost::ut::expect(boost::ut::eq(state->tasks.size(), std::size_t{1}));
+
+    std::unique_ptr<data::tstate> result =
+        parse_state(data::serialize(*state));
+    expect_true(std::ranges::equal(result->archived,
+                                   std::array{std::size_t{2}}));
+    expect_false(data::parse_archive(*result, data::serialize_archive(*state),
+                                     0));
+    expect_eq(result->archive[0], state->archive[0]);
+  };
+};
+
+} // namespace
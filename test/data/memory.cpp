@@ -0,0 +1,49 @@
+import ut_helpers;
+
+import data;
+
+import boost.ut;
+
+import std;
+
+namespace {
+
+using namespace boost::ut::literals;
+
+boost::ut::suite<"memory"> suite = [] {
+  "memory_usage"_test = [] {
+    std::string description(100, 'x');
+    std::string input = std::format(R"([label]
+id=1
+name=a
+
+[archive]
+ids=2, 3
+
+[task]
+id=1
+title=t
+description={}
+labels=1
+)",
+                                    description);
+    data::tmemory_usage usage = data::memory_usage(*parse_state(input));
+    boost::ut::expect(boost::ut::eq(usage.records.count, std::size_t{2}));
+    boost::ut::expect(boost::ut::eq(
+        usage.records.size, sizeof(data::tlabel) + sizeof(data::ttask)));
+    expect_true(usage.records.capacity >= usage.records.size);
+
+    boost::ut::expect(boost::ut::eq(usage.strings.count, std::size_t{4}));
+    boost::ut::expect(boost::ut::eq(usage.strings.size, std::size_t{102}));
+    // Only the description doesn't fit in its string.
+    expect_true(usage.strings.capacity > 100);
+    expect_true(usage.strings.capacity < 200);
+
+    boost::ut::expect(boost::ut::eq(usage.ids.count, std::size_t{1}));
+    boost::ut::expect(boost::ut::eq(usage.ids.size, sizeof(std::size_t)));
+
+    boost::ut::expect(boost::ut::eq(usage.archive.count, std::size_t{2}));
+  };
+};
+
+} // namespace
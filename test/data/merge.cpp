@@ -0,0 +1,155 @@
+import ut_helpers;
+
+import data;
+
+import boost.ut;
+
+import std;
+
+namespace {
+
+using namespace boost::ut::literals;
+
+/** Parses @p input as board @p board of two boards. */
+std::unique_ptr<data::tstate> parse(std::string_view input,
+                                    std::size_t board) {
+  std::unique_ptr<data::tstate> result = parse_state(input);
+  expect_true(data::namespace_ids(*result, board, 2));
+  return result;
+}
+
+/** Returns the error of merging and resolving @p first and @p second. */
+std::optional<std::string> merge(std::string_view first,
+                                 std::string_view second) {
+  std::vector<std::unique_ptr<data::tstate>> states;
+  states.push_back(parse(first, 0));
+  states.push_back(parse(second, 1));
+  std::unique_ptr<data::tstate> state = data::merge(std::move(states));
+  std::optional<std::string> result = data::resolve_references(*state);
+  expect_true(data::set_state(std::move(state)));
+  return result;
+}
+
+constexpr std::string_view board = R"([label]
+id=1
+name=label
+
+[project]
+id=1
+name=project
+
+[group]
+id=1
+project=1
+name=group
+
+[task]
+id=1
+group=1
+title=first
+
+[task]
+id=2
+project=1
+title=second
+labels=1
+dependencies=1
+requirements=1
+)";
+
+boost::ut::suite<"merge"> suite = [] {
+  "board_id"_test = [] {
+    boost::ut::expect(boost::ut::eq(data::board_id(0, 5), std::size_t{5}));
+    boost::ut::expect(boost::ut::eq(data::board_id(1, 0), std::size_t{0}));
+    boost::ut::expect(
+        boost::ut::eq(data::board_of(data::board_id(3, 5)), std::size_t{3}));
+  };
+
+  "first_board_is_unchanged"_test = [] {
+    std::unique_ptr<data::tstate> state = parse(board, 0);
+    boost::ut::expect(boost::ut::eq(state->tasks[1].id, std::size_t{2}));
+    boost::ut::expect(
+        boost::ut::eq(state->tasks[1].dependencies[0], std::size_t{1}));
+  };
+
+  "too_large_id"_test = [] {
+    constexpr std::string_view input = R"([label]
+id=4294967296
+name=label
+)";
+    auto parse = [&] { return std::move(data::parse(input)).value(); };
+    expect_true(data::namespace_ids(*parse(), 0, 1));
+    // The first board would overlap the ids of the second board.
+    expect_false(data::namespace_ids(*parse(), 0, 2));
+    expect_false(data::namespace_ids(*parse(), 1, 2));
+  };
+
+  "references_stay_in_their_board"_test = [] {
+    std::vector<std::unique_ptr<data::tstate>> states;
+    states.push_back(parse(board, 0));
+    states.push_back(parse(board, 1));
+    expect_true(data::set_state(data::merge(std::move(states))));
+
+    const data::tstate &state = data::get_state();
+    boost::ut::expect(boost::ut::eq(state.labels.size(), std::size_t{2}));
+    boost::ut::expect(boost::ut::eq(state.projects.size(), std::size_t{2}));
+    boost::ut::expect(boost::ut::eq(state.groups.size(), std::size_t{2}));
+    boost::ut::expect(boost::ut::eq(state.tasks.size(), std::size_t{4}));
+
+    // The records with id 1 of the second board.
+    std::size_t first = data::board_id(1, 1);
+    const data::ttask &task = data::get_task(data::board_id(1, 2));
+    expect_true(task.title == "second");
+    boost::ut::expect(boost::ut::eq(task.project, first));
+    boost::ut::expect(boost::ut::eq(task.labels[0], first));
+    boost::ut::expect(boost::ut::eq(task.dependencies[0], first));
+    boost::ut::expect(boost::ut::eq(task.requirements[0], first));
+    boost::ut::expect(boost::ut::eq(data::get_group(first).project, first));
+
+    // The first task of the second board blocks only the second task of the
+    // second board.
+    data::set_status(first, data::ttask::tstatus::done);
+    expect_false(data::is_blocked(task));
+    expect_true(data::is_blocked(data::get_task(2)));
+  };
+
+  "references_to_other_boards"_test = [] {
+    constexpr std::string_view second = R"([task]
+id=1
+title=other
+dependencies=0:1, 1
+requirements=0:1
+)";
+    std::optional<std::string> error = merge(board, second);
+    expect_false(error.has_value()) << error.value_or("");
+
+    const data::ttask &task = data::get_task(data::board_id(1, 1));
+    expect_true(std::ranges::equal(
+        task.dependencies, std::array{std::size_t{1}, data::board_id(1, 1)}));
+    expect_true(
+        std::ranges::equal(task.requirements, std::array{std::size_t{1}}));
+    expect_true(data::is_blocked(task));
+    expect_true(data::format_id(task.id) == "1:1");
+    expect_true(data::format_id(task.dependencies[0]) == "1");
+
+    data::set_status(1, data::ttask::tstatus::done);
+    data::set_status(2, data::ttask::tstatus::done);
+    data::set_status(data::board_id(1, 1), data::ttask::tstatus::done);
+    expect_false(data::is_blocked(task));
+  };
+
+  "unresolved_reference"_test = [] {
+    boost::ut::expect(boost::ut::eq(
+        merge(board, "[task]\nid=1\ntitle=t\ndependencies=0:9\n")
+            .value_or(""),
+        std::string{"id field »dependencies« of task »1:1« has no linked "
+                    "record for value »9«"}));
+    boost::ut::expect(boost::ut::eq(
+        merge(board, "[task]\nid=1\ntitle=t\nrequirements=2:1\n")
+            .value_or(""),
+        std::string{"task »1:1« refers to board 2 in field »requirements«, "
+                    "which is not loaded"}));
+  };
+};
+
+} // namespace
@@ -0,0 +1,128 @@
+import ut_helpers;
+
+import data;
+
+import boost.ut;
+
+import std;
+
+namespace {
+
+using namespace boost::ut::literals;
+
+constexpr std::string_view board = R"([project]
+id=1
+name=project
+
+[group]
+id=1
+project=1
+name=group
+
+[task]
+id=1
+project=1
+title=first
+
+[task]
+id=2
+group=1
+title=second
+)";
+
+void set_state() {
+  expect_true(data::set_state(parse_state(board)));
+}
+
+boost::ut::suite<"notify"> suite = [] {
+  "task"_test = [] {
+    set_state();
+    std::vector<std::size_t> changes;
+    data::tsubscription subscription = data::subscribe(
+        data::tentity::task, 1, data::tattribute::status,
+        [&](const data::tchange &change) { changes.push_back(change.id); });
+
+    data::set_status(1, data::ttask::tstatus::progress);
+    data::set_status(2, data::ttask::tstatus::progress);
+    // An unchanged status is not a change.
+    data::set_status(1, data::ttask::tstatus::progress);
+    boost::ut::expect(boost::ut::eq(changes, std::vector<std::size_t>{1}));
+    boost::ut::expect(boost::ut::eq(data::get_task(1).status,
+                                    data::ttask::tstatus::progress));
+  };
+
+  "all_records"_test = [] {
+    set_state();
+    std::vector<std::size_t> changes;
+    data::tsubscription subscription = data::subscribe(
+        data::tentity::task, {}, data::tattribute::any,
+        [&](const data::tchange &change) { changes.push_back(change.id); });
+
+    data::set_status(1, data::ttask::tstatus::done);
+    data::set_status(2, data::ttask::tstatus::review);
+    boost::ut::expect(boost::ut::eq(changes, std::vector<std::size_t>{1, 2}));
+  };
+
+  "field"_test = [] {
+    set_state();
+    std::vector<data::tattribute> changes;
+    data::tsubscription active = data::subscribe(
+        data::tentity::project, 1, data::tattribute::active,
+        [&](const data::tchange &change) {
+          changes.push_back(change.attribute);
+        });
+    data::tsubscription status = data::subscribe(
+        data::tentity::project, 1, data::tattribute::status,
+        [&](const data::tchange &change) {
+          changes.push_back(change.attribute);
+        });
+
+    data::set_project_active(1, false);
+    data::set_group_active(1, false);
+    boost::ut::expect(boost::ut::eq(changes.size(), std::size_t{1}));
+    expect_false(data::get_project(1).active);
+    expect_false(data::get_group(1).active);
+  };
+
+  "unsubscribe"_test = [] {
+    set_state();
+    std::size_t changes = 0;
+    {
+      data::tsubscription subscription =
+          data::subscribe(data::tentity::task, {}, data::tattribute::any,
+                          [&](const data::tchange &) { ++changes; });
+      data::set_status(1, data::ttask::tstatus::done);
+    }
+    data::set_status(2, data::ttask::tstatus::done);
+    boost::ut::expect(boost::ut::eq(changes, std::size_t{1}));
+  };
+
+  "unsubscribe_while_notifying"_test = [] {
+    set_state();
+    std::size_t changes = 0;
+    data::tsubscription second;
+    data::tsubscription first = data::subscribe(
+        data::tentity::task, 1, data::tattribute::any,
+        [&](const data::tchange &) {
+          ++changes;
+          second.reset();
+        });
+    second = data::subscribe(data::tentity::task, {}, data::tattribute::any,
+                             [&](const data::tchange &) { ++changes; });
+
+    data::set_status(1, data::ttask::tstatus::done);
+    boost::ut::expect(boost::ut::eq(changes, std::size_t{1}));
+  };
+
+  "members"_test = [] {
+    set_state();
+    data::tdependents dependents{data::get_state()};
+    boost::ut::expect(
+        boost::ut::eq(dependents.members_of(data::get_project(1)),
+                      std::vector<std::size_t>{1, 2}));
+    boost::ut::expect(boost::ut::eq(dependents.members_of(data::get_group(1)),
+                                    std::vector<std::size_t>{2}));
+  };
+};
+
+} // namespace
@@ -121,5 +121,36 @@ ID=2
     expect_eq(result.error(),
               data::tparse_error{10, "ID=2", "invalid field name"});
   };
+
+  "arena"_test = [] {
+    std::string_view input = R"(
+[label]
+id=1
+name=label
+
+[task]
+id=1
+title=hello
+description=a description that does not fit in the small string buffer
+labels=1
+)";
+
+    std::expected<std::unique_ptr<data::tstate>, data::tparse_error> result =
+        data::parse(input);
+
+    expect_true(result) << [&] { return format(result.error()); }
+                        << boost::ut::fatal;
+    const data::tstate &state = **result;
+    std::pmr::memory_resource *arena = state.arena.get();
+    expect_true(arena);
+    expect_true(state.labels.get_allocator().resource() == arena);
+    expect_true(state.labels[0].name.get_allocator().resource() == arena);
+    expect_true(state.tasks.get_allocator().resource() == arena);
+    expect_true(state.tasks[0].description.get_allocator().resource() ==
+                arena);
+    expect_true(state.tasks[0].labels.get_allocator().resource() == arena);
+    expect_true(state.tasks[0].dependencies.get_allocator().resource() ==
+                arena);
+  };
 };
 } // namespace
@@ -983,6 +983,41 @@ dependencies=10,a,    20)";
                                  "invalid number for field »dependencies«"});
   };
 
+  "after_dependencies_other_board"_test = [] {
+    // The references to other boards are resolved after merging.
+    std::string_view input = R"(
+[task]
+id=1
+title=abc
+dependencies=10,2:15)";
+
+    std::expected<std::unique_ptr<data::tstate>, data::tparse_error> result =
+        data::parse(input);
+
+    expect_true(result) << [&] { return format(result.error()); }
+                        << boost::ut::fatal;
+    expect_true(std::ranges::equal(
+        (*result)->tasks[0].dependencies,
+        std::array{std::size_t{10},
+                   data::board_reference | data::board_id(2, 15)}));
+  };
+
+  "after_dependencies_invalid_board"_test = [] {
+    std::string_view input = R"(
+[task]
+id=1
+title=abc
+dependencies=10,a:15)";
+
+    std::expected<std::unique_ptr<data::tstate>, data::tparse_error> result =
+        data::parse(input);
+
+    assert_false(result);
+    expect_eq(result.error(),
+              data::tparse_error{5, "10,a:15",
+                                 "invalid board for field »dependencies«"});
+  };
+
   "after_dependencies_zero_length_number"_test = [] {
     std::string_view input = R"(
 [task]
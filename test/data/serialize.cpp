@@ -0,0 +1,99 @@
+import ut_helpers;
+
+import data;
+
+import boost.ut;
+
+import std;
+
+namespace {
+
+using namespace boost::ut::literals;
+
+boost::ut::suite<"serialize"> suite = [] {
+  "empty"_test = [] {
+    expect_true(data::serialize(data::tstate{}).empty());
+  };
+
+  "defaults_are_omitted"_test = [] {
+    std::string_view input = R"([label]
+id=1
+name=a
+
+[project]
+id=1
+name=a
+
+[group]
+id=1
+project=1
+name=a
+
+[task]
+id=1
+title=a
+
+)";
+
+    boost::ut::expect(
+        boost::ut::eq(data::serialize(*parse_state(input)), input));
+  };
+
+  "round_trip"_test = [] {
+    std::string_view input = R"(
+[label]
+id=1
+name=bug
+description=Something is broken
+color=RED
+
+[project]
+id=10
+name=kaban
+color=gray
+active=false
+
+[group]
+id=20
+project=10
+name=gui
+description=<<<
+The user interface.
+With a second line.
+>>>
+color=white
+active=false
+
+[task]
+id=100
+project=10
+title=first
+status=done
+after=2024.2.29
+labels=1
+
+[task]
+id=200
+group=20
+title=second
+description=<<<
+A multiline
+
+description.
+>>>
+status=progress
+dependencies=100
+requirements=20
+)";
+
+    std::unique_ptr<data::tstate> expected = parse_state(input);
+    std::string output = data::serialize(*expected);
+    expect_eq(*parse_state(output), *expected);
+
+    // Serializing is stable.
+    boost::ut::expect(
+        boost::ut::eq(data::serialize(*parse_state(output)), output));
+  };
+};
+
+} // namespace
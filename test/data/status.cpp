@@ -129,6 +129,27 @@ bool is_active_group(bool project_active, bool group_active) {
   return data::is_active(data::get_task(100));
 }
 
+data::tcolumn_index get_column_index(data::ttask::tstatus status,
+                                     bool blocked, bool active) {
+  std::expected<void, std::nullptr_t> result =
+      data::set_state(std::make_unique<data::tstate>(data::tstate{
+          .projects = {data::tproject{.id = 1, .name = "a", .active = active}},
+          .tasks = {data::ttask{.id = 100,
+                                .title = "a",
+                                .status = blocked
+                                              ? data::ttask::tstatus::backlog
+                                              : data::ttask::tstatus::done},
+                    data::ttask{.id = 200,
+                                .project = 1,
+                                .title = "b",
+                                .status = status,
+                                .dependencies = {100}}}}));
+
+  expect_true(result);
+
+  return data::get_column_index(data::get_task(200));
+}
+
 boost::ut::suite<"status"> suite = [] {
   "is_blocked_one_dependency"_test = [] {
     expect_true(is_blocked_one_dependency(data::ttask::tstatus::backlog));
@@ -231,6 +252,74 @@ boost::ut::suite<"status"> suite = [] {
     expect_false(is_active_project(false));
   };
 
+  "get_column_index"_test = [] {
+    using enum data::ttask::tstatus;
+    using column = data::tcolumn_index;
+    boost::ut::expect(get_column_index(backlog, false, true) ==
+                      column::backlog);
+    boost::ut::expect(get_column_index(backlog, true, true) ==
+                      column::blocked);
+    boost::ut::expect(get_column_index(backlog, false, false) ==
+                      column::inactive);
+    // Inactive takes precedence over blocked.
+    boost::ut::expect(get_column_index(backlog, true, false) ==
+                      column::inactive);
+
+    // Only tasks in the backlog can be blocked or inactive.
+    boost::ut::expect(get_column_index(selected, true, false) ==
+                      column::selected);
+    boost::ut::expect(get_column_index(progress, true, false) ==
+                      column::progress);
+    boost::ut::expect(get_column_index(review, true, false) ==
+                      column::review);
+    boost::ut::expect(get_column_index(done, true, false) == column::done);
+    boost::ut::expect(get_column_index(discarded, true, false) ==
+                      column::discarded);
+  };
+
+  "set_status"_test = [] {
+    expect_true(data::set_state(std::make_unique<data::tstate>(data::tstate{
+        .tasks = {data::ttask{.id = 100, .title = "a"},
+                  data::ttask{.id = 200,
+                              .title = "b",
+                              .dependencies = {100}}}})));
+
+    boost::ut::expect(data::get_column_index(data::get_task(200)) ==
+                      data::tcolumn_index::blocked);
+
+    data::set_status(100, data::ttask::tstatus::done);
+    boost::ut::expect(data::get_task(100).status ==
+                      data::ttask::tstatus::done);
+    boost::ut::expect(data::get_column_index(data::get_task(200)) ==
+                      data::tcolumn_index::backlog);
+  };
+
+  "dependents"_test = [] {
+    expect_true(data::set_state(std::make_unique<data::tstate>(data::tstate{
+        .projects = {data::tproject{.id = 1, .name = "a"}},
+        .groups = {data::tgroup{.id = 10, .project = 1, .name = "a"}},
+        .tasks = {data::ttask{.id = 100, .group = 10, .title = "a"},
+                  data::ttask{.id = 200, .title = "b"},
+                  data::ttask{.id = 300,
+                              .title = "c",
+                              .dependencies = {100}},
+                  data::ttask{.id = 400,
+                              .title = "d",
+                              .dependencies = {100, 200},
+                              .requirements = {10}},
+                  data::ttask{.id = 500,
+                              .title = "e",
+                              .requirements = {10}}}})));
+
+    data::tdependents dependents{data::get_state()};
+    boost::ut::expect(
+        dependents.affected_by(data::get_task(100)) ==
+        std::vector<std::size_t>{300, 400, 500});
+    boost::ut::expect(dependents.affected_by(data::get_task(200)) ==
+                      std::vector<std::size_t>{400});
+    boost::ut::expect(dependents.affected_by(data::get_task(300)).empty());
+  };
+
   "is_active_group"_test = [] {
     expect_true(is_active_group(true, true));
     expect_false(is_active_group(true, false));
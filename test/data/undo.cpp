@@ -0,0 +1,95 @@
+import ut_helpers;
+
+import data;
+
+import boost.ut;
+
+import std;
+
+namespace {
+
+using namespace boost::ut::literals;
+
+using tstatus = data::ttask::tstatus;
+
+constexpr std::string_view board = R"([project]
+id=1
+name=project
+
+[group]
+id=10
+project=1
+name=group
+
+[task]
+id=100
+title=a
+
+[task]
+id=200
+title=b
+)";
+
+tstatus status(std::size_t id) { return data::get_task(id).status; }
+
+boost::ut::suite<"undo"> suite = [] {
+  "undo_redo"_test = [] {
+    expect_true(data::set_state(parse_state(board)));
+    expect_false(data::undo());
+    expect_false(data::redo());
+
+    std::size_t notified = 0;
+    data::tsubscription subscription =
+        data::subscribe(data::tentity::task, 200, data::tattribute::status,
+                        [&](const data::tchange &) { ++notified; });
+
+    data::set_status(200, tstatus::progress);
+    data::set_status(200, tstatus::review);
+    data::set_project_active(1, false);
+
+    expect_true(data::undo());
+    expect_true(data::get_project(1).active);
+    expect_true(data::undo());
+    boost::ut::expect(boost::ut::eq(status(200), tstatus::progress));
+    expect_true(data::undo());
+    boost::ut::expect(boost::ut::eq(status(200), tstatus::backlog));
+    expect_false(data::undo());
+    // Every change and every undo notifies the subscribers.
+    boost::ut::expect(boost::ut::eq(notified, std::size_t{4}));
+
+    expect_true(data::redo());
+    boost::ut::expect(boost::ut::eq(status(200), tstatus::progress));
+
+    // A new change drops the changes to redo.
+    data::set_status(100, tstatus::done);
+    expect_false(data::redo());
+    boost::ut::expect(boost::ut::eq(status(100), tstatus::done));
+    boost::ut::expect(boost::ut::eq(status(200), tstatus::progress));
+  };
+
+  "changes_since"_test = [] {
+    expect_true(data::set_state(parse_state(board)));
+    std::size_t start = data::version();
+    std::optional<data::tchanges> changes = data::changes_since(start);
+    assert_false(!changes);
+    expect_true(changes->tasks.empty());
+
+    data::set_status(200, tstatus::progress);
+    data::set_group_active(10, false);
+    changes = data::changes_since(start);
+    assert_false(!changes);
+    boost::ut::expect(
+        boost::ut::eq(changes->tasks, std::vector<std::size_t>{200}));
+    boost::ut::expect(
+        boost::ut::eq(changes->groups, std::vector<std::size_t>{10}));
+    expect_true(changes->labels.empty());
+    expect_true(changes->projects.empty());
+
+    // Replacing the state drops the history.
+    expect_true(data::set_state(parse_state(board)));
+    expect_false(data::changes_since(start));
+    expect_false(data::undo());
+  };
+};
+
+} // namespace
@@ -0,0 +1,148 @@
+import ut_helpers;
+
+import data;
+
+import boost.ut;
+
+import std;
+
+namespace {
+
+using namespace boost::ut::literals;
+
+void expect_error(const data::tparse_error &error, int line_no,
+                  std::string_view message) {
+  boost::ut::expect(boost::ut::eq(error.line_no, line_no));
+  boost::ut::expect(boost::ut::eq(error.message, message));
+}
+
+void assert_size(std::span<const data::tparse_error> errors,
+                 std::size_t size) {
+  using namespace boost::ut::operators;
+  boost::ut::expect((boost::ut::eq(errors.size(), size)) >> boost::ut::fatal);
+}
+
+boost::ut::suite<"validate"> suite = [] {
+  "valid"_test = [] {
+    expect_true(data::validate(R"([project]
+id=1
+name=project
+
+[task]
+id=1
+project=1
+title=task
+)")
+                    .empty());
+  };
+
+  "all_errors"_test = [] {
+    constexpr std::string_view input = R"([label]
+id=1
+name=a
+
+[label]
+id=1
+name=b
+
+[task]
+id=1
+title=task
+labels=2
+
+[task]
+id=2
+
+[group]
+id=1
+project=9
+name=group
+)";
+    std::vector<data::tparse_error> errors = data::validate(input);
+    assert_size(errors, 4);
+    expect_error(errors[0], 5, "id field »id« has multiple values »1«");
+    expect_error(errors[1], 9,
+                 "id field »labels« has no linked record for value »2«");
+    expect_error(errors[2], 14, "missing mandatory field »title«");
+    expect_error(errors[3], 17,
+                 "id field »project« has no linked record for value »9«");
+
+    // The first error is the error of parse.
+    std::expected<std::unique_ptr<data::tstate>, data::tparse_error> result =
+        data::parse(input);
+    assert_false(result);
+    expect_eq(errors[0], result.error());
+  };
+
+  "declared_later"_test = [] {
+    std::vector<data::tparse_error> errors = data::validate(R"([task]
+id=1
+project=1
+title=task
+
+[project]
+id=1
+name=project
+)");
+    assert_size(errors, 1);
+    expect_error(errors[0], 1,
+                 "id field »project« has no linked record for value »1«");
+  };
+
+  "nested_and_multiline"_test = [] {
+    std::vector<data::tparse_error> errors = data::validate(R"([task]
+id=1
+title=<<<
+[label]
+>>>
+
+[task]
+id=2
+title=b
+[task]
+id=3
+title=c
+)");
+    assert_size(errors, 1);
+    expect_eq(errors[0], data::tparse_error{10, "[task]",
+                                            "headers can't be nested"});
+  };
+
+  "not_attached"_test = [] {
+    std::vector<data::tparse_error> errors = data::validate(R"(id=1
+
+[archive]
+ids=1
+
+[task]
+id=1
+title=task
+
+title=value
+)");
+    assert_size(errors, 3);
+    expect_eq(errors[0], data::tparse_error{
+                             1, "id=1", "value is not attached to a header"});
+    expect_error(errors[1], 6, "task »1« is both active and archived");
+    expect_eq(errors[2],
+              data::tparse_error{10, "title=value",
+                                 "value is not attached to a header"});
+  };
+
+  "large"_test = [] {
+    // Enough records to validate on several threads.
+    std::string input = "[project]\nid=1\nname=project\n\n";
+    for (std::size_t i = 1; i <= 5000; ++i)
+      std::format_to(std::back_inserter(input),
+                     "[task]\nid={}\nproject={}\ntitle=task\n\n",
+                     i == 4000 ? 1 : i, i == 3000 ? 2 : 1);
+
+    std::vector<data::tparse_error> errors = data::validate(input);
+    assert_size(errors, 2);
+    expect_error(errors[0], 15000,
+                 "id field »project« has no linked record for value »2«");
+    expect_error(errors[1], 20000, "id field »id« has multiple values »1«");
+  };
+};
+
+} // namespace
@@ -0,0 +1,77 @@
+import ut_helpers;
+
+import data;
+import ftxui;
+import gui;
+
+import boost.ut;
+
+import std;
+
+namespace {
+
+using namespace boost::ut::literals;
+
+constexpr std::string_view board = R"([archive]
+ids=2
+
+[task]
+id=1
+title=active
+)";
+
+constexpr std::string_view archive = R"([task]
+id=2
+title=archived
+status=done
+)";
+
+/** Returns the text of a frame of @p component. */
+std::string render(const ftxui::Component &component) {
+  ftxui::Screen screen{200, 30};
+  ftxui::Render(screen, component->Render());
+  return screen.ToString();
+}
+
+boost::ut::suite<"board"> suite = [] {
+  "reopen_archived"_test = [] {
+    data::set_archive_loader([](data::tstate &state) {
+      return !data::parse_archive(state, archive, 0);
+    });
+    expect_true(data::set_state(parse_state(board)));
+    expect_true(data::load_archive());
+
+    // Without an active screen the board loads while it is created.
+    ftxui::Component component = gui::board();
+    std::string before = render(component);
+    expect_true(before.contains("Done (1/2)"));
+    expect_false(before.contains("archived"));
+
+    // Reopening moves the tasks, the columns must not refer to the old ones.
+    data::set_status(2, data::ttask::tstatus::progress);
+    std::string after = render(component);
+    expect_true(after.contains("In progress (1/2)"));
+    expect_true(after.contains("Done (0/2)"));
+    expect_true(after.contains("archived"));
+    data::set_archive_loader({});
+  };
+
+  "server_owns_history"_test = [] {
+    expect_true(data::set_state(parse_state(board)));
+    ftxui::Component component = gui::board();
+    data::set_status(1, data::ttask::tstatus::selected);
+
+    // The server saved the change, undoing it locally would diverge.
+    gui::set_status_sender([](std::size_t, data::ttask::tstatus) {
+      return false;
+    });
+    expect_false(component->OnEvent(ftxui::Event::Character('u')));
+    expect_true(data::get_task(1).status == data::ttask::tstatus::selected);
+
+    gui::set_status_sender({});
+    expect_true(component->OnEvent(ftxui::Event::Character('u')));
+    expect_true(data::get_task(1).status == data::ttask::tstatus::backlog);
+  };
+};
+
+} // namespace
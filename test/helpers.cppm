@@ -14,6 +14,17 @@ message {}
                      error.line_no, error.line, error.message);
 }
 
+/** Returns the state parsed from @p input, a parse error fails the test. */
+export std::unique_ptr<data::tstate> parse_state(std::string_view input) {
+  std::expected<std::unique_ptr<data::tstate>, data::tparse_error> result =
+      data::parse(input);
+  if (!result) {
+    boost::ut::expect(false) << format(result.error()) << boost::ut::fatal;
+    return {};
+  }
+  return std::move(result).value();
+}
+
 // Boost UT requires the operator<< to be in the namespace of the argument.
 namespace data {
 std::ostream &operator<<(std::ostream &os, tcolor color) {
@@ -0,0 +1,97 @@
+import ut_helpers;
+
+import persistent;
+
+import boost.ut;
+
+import std;
+
+namespace {
+
+using namespace boost::ut::literals;
+
+std::vector<int> to_vector(const persistent::tvector<int> &input) {
+  std::vector<int> result;
+  input.for_each([&](int value) { result.push_back(value); });
+  return result;
+}
+
+std::vector<std::size_t> diff(const persistent::tvector<int> &lhs,
+                              const persistent::tvector<int> &rhs) {
+  std::vector<std::size_t> result;
+  lhs.diff(rhs, [&](std::size_t index) { result.push_back(index); });
+  return result;
+}
+
+boost::ut::suite<"persistent_vector"> suite = [] {
+  "empty"_test = [] {
+    persistent::tvector<int> input;
+    expect_true(input.empty());
+    boost::ut::expect(boost::ut::eq(input.size(), std::size_t{0}));
+    boost::ut::expect(boost::ut::eq(to_vector(input), std::vector<int>{}));
+  };
+
+  "range"_test = [] {
+    // Large enough to require three levels in the trie.
+    std::vector<int> expected =
+        std::views::iota(0, 2000) | std::ranges::to<std::vector>();
+    persistent::tvector<int> input{expected};
+
+    boost::ut::expect(boost::ut::eq(input.size(), expected.size()));
+    boost::ut::expect(boost::ut::eq(input[0], 0));
+    boost::ut::expect(boost::ut::eq(input[1999], 1999));
+    boost::ut::expect(boost::ut::eq(to_vector(input), expected));
+  };
+
+  "push_back"_test = [] {
+    std::vector<int> expected;
+    persistent::tvector<int> input;
+    for (int i = 0; i < 2000; ++i) {
+      input = input.push_back(i);
+      expected.push_back(i);
+    }
+
+    boost::ut::expect(boost::ut::eq(to_vector(input), expected));
+  };
+
+  "set"_test = [] {
+    persistent::tvector<int> original{std::views::iota(0, 100)};
+    persistent::tvector<int> modified = original.set(42, -1);
+
+    // The original version is not affected.
+    boost::ut::expect(boost::ut::eq(original[42], 42));
+    boost::ut::expect(boost::ut::eq(modified[42], -1));
+    boost::ut::expect(boost::ut::eq(modified[41], 41));
+    boost::ut::expect(boost::ut::eq(modified[43], 43));
+
+    boost::ut::expect(boost::ut::throws([&] { (void)original.set(100, 0); }));
+  };
+
+  "diff"_test = [] {
+    persistent::tvector<int> original{std::views::iota(0, 1000)};
+    boost::ut::expect(
+        boost::ut::eq(diff(original, original), std::vector<std::size_t>{}));
+
+    persistent::tvector<int> modified = original.set(3, 3).set(500, 0);
+    boost::ut::expect(boost::ut::eq(diff(original, modified),
+                                    std::vector<std::size_t>{3, 500}));
+
+    // Growing the trie adds a level.
+    modified = original.push_back(1000).push_back(1001);
+    boost::ut::expect(boost::ut::eq(diff(original, modified),
+                                    std::vector<std::size_t>{1000, 1001}));
+    boost::ut::expect(boost::ut::eq(diff(modified, original),
+                                    std::vector<std::size_t>{1000, 1001}));
+
+    persistent::tvector<int> small{std::views::iota(0, 10)};
+    modified = small;
+    for (int i = 10; i < 40; ++i)
+      modified = modified.push_back(i);
+    boost::ut::expect(boost::ut::eq(
+        diff(small, modified),
+        std::views::iota(std::size_t{10}, std::size_t{40}) |
+            std::ranges::to<std::vector>()));
+  };
+};
+
+} // namespace
@@ -0,0 +1,172 @@
+export module trace;
+import std;
+
+#ifdef KABAN_TRACE
+
+struct tevent {
+  const char *name;
+  std::chrono::steady_clock::time_point begin;
+  std::chrono::steady_clock::time_point end;
+};
+
+/**
+ * Owns the events of all threads.
+ *
+ * Every thread records in its own buffer, so recording does not lock. A
+ * buffer moves its events to the registry under the lock when it is full and
+ * when its thread exits. The events are written when the application exits,
+ * at that point the other threads should have been joined; the events of a
+ * thread still running are not written.
+ */
+class tregistry {
+public:
+  tregistry() = default;
+  tregistry(const tregistry &) = delete;
+  tregistry(tregistry &&) = delete;
+  tregistry &operator=(const tregistry &) = delete;
+  tregistry &operator=(tregistry &&) = delete;
+  ~tregistry() { write(); }
+
+  /** Returns the number of the next thread, the tid of the trace. */
+  std::size_t add_thread() {
+    std::lock_guard lock{mutex_};
+    return threads_++;
+  }
+
+  /** Takes the @p events of @p thread. */
+  void flush(std::size_t thread, std::vector<tevent> &events) {
+    std::lock_guard lock{mutex_};
+    for (const tevent &event : events)
+      events_.emplace_back(thread, event);
+    events.clear();
+  }
+
+  /**
+   * Writes the events as Chrome trace-event JSON.
+   *
+   * The file can be opened in Perfetto or chrome://tracing. The file name is
+   * taken from the environment variable KABAN_TRACE_FILE. Without events no
+   * file is written, so a run without spans does not overwrite a trace.
+   */
+  void write() {
+    std::lock_guard lock{mutex_};
+    if (events_.empty())
+      return;
+
+    const char *file_name = std::getenv("KABAN_TRACE_FILE");
+    std::ofstream file{file_name ? file_name : "kaban.trace.json"};
+    if (!file)
+      return;
+
+    auto microseconds = [](std::chrono::steady_clock::duration duration) {
+      return std::chrono::duration<double, std::micro>(duration).count();
+    };
+
+    std::print(file, R"({{"traceEvents":[)");
+    const char *separator = "\n";
+    for (const auto &[thread, event] : events_) {
+      std::print(file,
+                 R"({}{{"name":"{}","ph":"X","ts":{:.3f},"dur":{:.3f},)"
+                 R"("pid":1,"tid":{}}})",
+                 separator, event.name, microseconds(event.begin - epoch_),
+                 microseconds(event.end - event.begin), thread);
+      separator = ",\n";
+    }
+    std::println(file, "\n]}}");
+  }
+
+private:
+  std::mutex mutex_{};
+  std::chrono::steady_clock::time_point epoch_{
+      std::chrono::steady_clock::now()};
+  std::size_t threads_{0};
+  /** The events of the flushed buffers, with the number of their thread. */
+  std::vector<std::pair<std::size_t, tevent>> events_{};
+};
+
+static tregistry registry;
+
+/**
+ * The events of a thread, not yet moved to the registry.
+ *
+ * The buffer of the main thread is destroyed before the registry, the
+ * thread-local objects of a thread are destroyed before the static objects.
+ */
+class tbuffer {
+public:
+  static constexpr std::size_t capacity = 4096;
+
+  tbuffer() { events_.reserve(capacity); }
+  tbuffer(const tbuffer &) = delete;
+  tbuffer(tbuffer &&) = delete;
+  tbuffer &operator=(const tbuffer &) = delete;
+  tbuffer &operator=(tbuffer &&) = delete;
+  ~tbuffer() { registry.flush(thread_, events_); }
+
+  void add(const char *name, std::chrono::steady_clock::time_point begin,
+           std::chrono::steady_clock::time_point end) {
+    events_.emplace_back(name, begin, end);
+    if (events_.size() == capacity)
+      registry.flush(thread_, events_);
+  }
+
+private:
+  std::size_t thread_{registry.add_thread()};
+  std::vector<tevent> events_{};
+};
+
+void record(const char *name, std::chrono::steady_clock::time_point begin,
+            std::chrono::steady_clock::time_point end) {
+  thread_local tbuffer buffer;
+  buffer.add(name, begin, end);
+}
+
+#endif
+
+export namespace trace {
+
+#ifdef KABAN_TRACE
+
+inline constexpr bool enabled = true;
+
+/**
+ * Records the time between its construction and destruction.
+ *
+ * The name is not copied, so it should be a string literal.
+ */
+class tspan {
+public:
+  explicit tspan(const char *name)
+      : name_(name), begin_(std::chrono::steady_clock::now()) {}
+  ~tspan() { record(name_, begin_, std::chrono::steady_clock::now()); }
+
+  tspan(const tspan &) = delete;
+  tspan(tspan &&) = delete;
+  tspan &operator=(const tspan &) = delete;
+  tspan &operator=(tspan &&) = delete;
+
+private:
+  const char *name_;
+  std::chrono::steady_clock::time_point begin_;
+};
+
+#else
+
+inline constexpr bool enabled = false;
+
+/** Tracing is disabled, the span does nothing. */
+class tspan {
+public:
+  explicit constexpr tspan(const char *) {}
+  // The destructor is user-provided, so an unused span does not warn.
+  ~tspan() {}
+
+  tspan(const tspan &) = delete;
+  tspan(tspan &&) = delete;
+  tspan &operator=(const tspan &) = delete;
+  tspan &operator=(tspan &&) = delete;
+};
+
+#endif
+
+} // namespace trace